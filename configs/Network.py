@@ -95,7 +95,8 @@ def define_options(parser):
         help="""routing algorithm in network.
             0: weight-based table
             1: XY (for Mesh. see garnet/RoutingUnit.cc)
-            2: Custom (see garnet/RoutingUnit.cc""",
+            2: Custom (see garnet/RoutingUnit.cc)
+            3: Congestion-aware custom (see garnet/RoutingUnit.cc)""",
     )
     parser.add_argument(
         "--network-fault-model",
@@ -127,6 +128,217 @@ def define_options(parser):
         default=[],
         help="Adding of hybrid Routers",
     )
+    parser.add_argument(
+        "--num-hybrid-routers",
+        type=int,
+        default=0,
+        help="""place this many hybrid routers automatically (minimizing
+            the average hop count with wireless shortcuts) when
+            --hybrid-routers is not given (Wireless_Mesh_XY)""",
+    )
+    parser.add_argument(
+        "--hybrid-placement-traffic",
+        default="",
+        help="""stats.txt of a previous run: weight the automatic hybrid
+            router placement by its traffic_distribution stats""",
+    )
+    parser.add_argument(
+        "--hybrid-route-table",
+        action="store_true",
+        default=False,
+        help="""precompute the hybrid routes of every router at init
+            (routing algorithm 2) instead of searching per packet""",
+    )
+    parser.add_argument(
+        "--num-wireless-channels",
+        type=int,
+        default=1,
+        help="""number of independent wireless channels
+            (each with its own token) among the hybrid routers""",
+    )
+    parser.add_argument(
+        "--wireless-rx-per-source",
+        action="store_true",
+        default=False,
+        help="""give each hybrid router one wireless receive port
+            (Wireless_In<src>, with its own VCs) per transmitting hybrid
+            router on every channel, instead of one shared port""",
+    )
+    def list_of_int_lists(arg):
+        return [list_of_int(group) for group in arg.split(';')]
+    parser.add_argument(
+        "--wireless-channel-routers",
+        action="store",
+        type=list_of_int_lists,
+        default=[],
+        help="""hybrid routers with a transceiver on each wireless
+            channel, one comma-separated group per channel, separated
+            by ';' (e.g. "0,9;18,27"). By default every hybrid router
+            is on every channel (Wireless_Mesh_XY)""",
+    )
+    parser.add_argument(
+        "--hybrid-vcs-per-vnet",
+        type=int,
+        default=0,
+        help="""virtual channels per virtual network of the hybrid
+            routers (Wireless_Mesh_XY, 0: --vcs-per-vnet)""",
+    )
+    parser.add_argument(
+        "--hybrid-buffers-per-data-vc",
+        type=int,
+        default=0,
+        help="""buffers per data virtual channel of the hybrid routers
+            (Wireless_Mesh_XY, 0: network default)""",
+    )
+    parser.add_argument(
+        "--hybrid-buffers-per-ctrl-vc",
+        type=int,
+        default=0,
+        help="""buffers per ctrl virtual channel of the hybrid routers
+            (Wireless_Mesh_XY, 0: network default)""",
+    )
+    parser.add_argument(
+        "--wireless-buffers-per-data-vc",
+        type=int,
+        default=0,
+        help="""buffers per data virtual channel of the wireless
+            receive ports (Wireless_Mesh_XY, 0: as the other ports of
+            the hybrid router)""",
+    )
+    parser.add_argument(
+        "--wireless-buffers-per-ctrl-vc",
+        type=int,
+        default=0,
+        help="""buffers per ctrl virtual channel of the wireless
+            receive ports (Wireless_Mesh_XY, 0: as the other ports of
+            the hybrid router)""",
+    )
+    parser.add_argument(
+        "--wireless-token-mode",
+        default="rotate",
+        choices=["rotate", "demand"],
+        help="""'rotate': the wireless token moves every cycle.
+            'demand': the token only moves to requesting hybrid routers""",
+    )
+    parser.add_argument(
+        "--wireless-token-hold",
+        default="none",
+        choices=["none", "tail", "flits", "queue"],
+        help="""'none': the token may move after every flit.
+            'tail': hold until the tail of the packet is sent.
+            'flits': hold until the tail, for at most
+            --wireless-token-hold-flits flits.
+            'queue': hold while wireless packets are pending, for at most
+            --wireless-token-hold-flits flits.""",
+    )
+    parser.add_argument(
+        "--wireless-token-hold-flits",
+        type=int,
+        default=8,
+        help="max flits sent per wireless token tenure",
+    )
+    parser.add_argument(
+        "--wireless-multicast",
+        action="store_true",
+        default=False,
+        help="""send single-flit multicast messages (e.g., invalidations)
+            as one packet broadcast on the wireless channel, forked
+            into unicast copies by the receiving hybrid routers.
+            Needs --routing-algorithm=2 or 3.""",
+    )
+    parser.add_argument(
+        "--garnet-arbitration",
+        default="round_robin",
+        choices=["round_robin", "qos"],
+        help="""'round_robin': switch allocation and the demand token
+            serve requesters in turn. 'qos': packets waiting since
+            --qos-starvation-cycles first, then control packets, then
+            the oldest ones""",
+    )
+    parser.add_argument(
+        "--qos-starvation-cycles",
+        type=int,
+        default=64,
+        help="cycles after which a packet is served first (qos)",
+    )
+    parser.add_argument(
+        "--lookahead-routing",
+        action="store_true",
+        default=False,
+        help="""compute the outport (and wireless destination) of the
+            next router one hop early, so that flits arriving over a
+            router-to-router link skip one router pipeline stage""",
+    )
+    parser.add_argument(
+        "--escape-vc",
+        action="store_true",
+        default=False,
+        help="""reserve the first VC of each vnet as an escape VC routed
+            XY, which adaptive packets fall back to when blocked.
+            Needs a mesh and --vcs-per-vnet >= 2.""",
+    )
+    parser.add_argument(
+        "--wireless-bypass",
+        action="store_true",
+        default=False,
+        help="""let flits arriving at a hybrid router over the wireless
+            channel go straight to switch traversal when their wired
+            outport and an outvc (or credit) are free""",
+    )
+    parser.add_argument(
+        "--garnet-path-stats",
+        action="store_true",
+        default=False,
+        help="""record the routers traversed by each packet and report a
+            path length histogram and per-router and per-hybrid-router
+            transit counts""",
+    )
+    parser.add_argument(
+        "--garnet-traffic-trace",
+        default="",
+        help="""inject the messages of this binary traffic trace of
+            (tick, src NI, dest NI, vnet, size) records from the network
+            interfaces, without protocol controllers consuming them""",
+    )
+    parser.add_argument(
+        "--garnet-traffic-trace-prefetch",
+        type=int,
+        default=65536,
+        help="traffic trace records read ahead of the current one",
+    )
+    parser.add_argument(
+        "--garnet-binary-trace",
+        default="",
+        help="""write a binary flit trace (inject, router arrival, switch
+            grant and eject records) to this file in the output
+            directory. Requires a build with tracing support.""",
+    )
+    parser.add_argument(
+        "--garnet-telemetry",
+        default="",
+        help="""write periodic samples of the router occupancy, output
+            credits, wireless queues and token holders to this file in
+            the output directory""",
+    )
+    parser.add_argument(
+        "--garnet-telemetry-interval",
+        type=int,
+        default=1000,
+        help="cycles between two telemetry samples",
+    )
+    parser.add_argument(
+        "--garnet-telemetry-routers",
+        type=list_of_int,
+        default=[],
+        help="comma separated routers sampled by the telemetry (all if "
+        "not given)",
+    )
+    parser.add_argument(
+        "--garnet-telemetry-csv",
+        action="store_true",
+        default=False,
+        help="write the telemetry as CSV instead of binary",
+    )
 
 
 def create_network(options, ruby):
@@ -179,6 +391,31 @@ def init_network(options, network, InterfaceClass):
         network.routing_algorithm = options.routing_algorithm
         network.garnet_deadlock_threshold = options.garnet_deadlock_threshold
         network.hybrid_routers=options.hybrid_routers
+        network.hybrid_route_table = options.hybrid_route_table
+        network.num_wireless_channels = options.num_wireless_channels
+        network.wireless_token_mode = (
+            "TOKEN_" + options.wireless_token_mode.upper()
+        )
+        network.wireless_token_hold = (
+            "HOLD_" + options.wireless_token_hold.upper()
+        )
+        network.wireless_token_hold_flits = options.wireless_token_hold_flits
+        network.wireless_multicast = options.wireless_multicast
+        network.arbitration = "ARB_" + options.garnet_arbitration.upper()
+        network.qos_starvation_cycles = options.qos_starvation_cycles
+        network.lookahead_routing = options.lookahead_routing
+        network.escape_vc = options.escape_vc
+        network.wireless_bypass = options.wireless_bypass
+        network.path_stats = options.garnet_path_stats
+        network.traffic_trace = options.garnet_traffic_trace
+        network.traffic_trace_prefetch = (
+            options.garnet_traffic_trace_prefetch
+        )
+        network.binary_trace = options.garnet_binary_trace
+        network.telemetry_file = options.garnet_telemetry
+        network.telemetry_interval = options.garnet_telemetry_interval
+        network.telemetry_routers = options.garnet_telemetry_routers
+        network.telemetry_csv = options.garnet_telemetry_csv
 
         # Create Bridges and connect them to the corresponding links
         for intLink in network.int_links:
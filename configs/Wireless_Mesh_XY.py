@@ -30,8 +30,162 @@ from m5.objects import *
 
 from common import FileSystemConfig
 
+import re
+
+from m5.util import fatal, inform
+
 from topologies.BaseTopology import SimpleTopology
 
+
+def read_traffic_matrix(stats_file, num_routers):
+    """Router to router packet counts from the data/ctrl
+    traffic_distribution stats of a previous run (summed over all the
+    dumps in stats_file)."""
+    pattern = re.compile(
+        r"\.(?:data|ctrl)_traffic_distribution\.n(\d+)\.n(\d+)\s+(\d+)"
+    )
+    traffic = [[0] * num_routers for _ in range(num_routers)]
+    with open(stats_file) as stats:
+        for line in stats:
+            match = pattern.search(line)
+            if match:
+                src, dst, packets = map(int, match.groups())
+                if src < num_routers and dst < num_routers:
+                    traffic[src][dst] += packets
+    return traffic
+
+
+def hybrid_hops(num_rows, num_columns, hybrids, traffic=None):
+    """Average hop count (weighted by traffic if given) when every
+    packet takes the shorter of its XY path and its hybrid path
+    (XY to a hybrid router, one wireless hop, XY to the destination)."""
+    num_routers = num_rows * num_columns
+
+    def hops(a, b):
+        return abs(a % num_columns - b % num_columns) + abs(
+            a // num_columns - b // num_columns
+        )
+
+    # The two nearest hybrid routers are enough to find the best pair
+    # of distinct hybrid routers
+    nearest = [
+        sorted((hops(r, h), h) for h in hybrids)[:2]
+        for r in range(num_routers)
+    ]
+
+    total = weight = 0
+    for src in range(num_routers):
+        for dst in range(num_routers):
+            w = traffic[src][dst] if traffic else 1
+            if w == 0 or src == dst:
+                continue
+            cost = hops(src, dst)
+            for (a, ha) in nearest[src]:
+                for (b, hb) in nearest[dst]:
+                    if ha != hb:
+                        cost = min(cost, a + 1 + b)
+            total += w * cost
+            weight += w
+    return total / weight if weight else 0.0
+
+
+def place_hybrid_routers(num_rows, num_columns, k, traffic=None):
+    """Picks k hybrid routers of a num_rows x num_columns mesh.
+
+    Weighted k-medians (weight: packets sent and received by a router,
+    uniform without traffic) on the Manhattan distance, starting from
+    an even spread over the mesh, followed by a local search moving
+    single hybrid routers to neighbouring routers while the average
+    hybrid_hops() improves (skipped above 16x16 to bound the run time).
+    """
+    num_routers = num_rows * num_columns
+    if k < 2 or k > num_routers:
+        fatal("Cannot place %d hybrid routers in a %dx%d mesh"
+              % (k, num_rows, num_columns))
+
+    if traffic:
+        weights = [
+            sum(traffic[r]) + sum(row[r] for row in traffic)
+            for r in range(num_routers)
+        ]
+    else:
+        weights = [1] * num_routers
+
+    def coords(r):
+        return (r % num_columns, r // num_columns)
+
+    def hops(a, b):
+        (ax, ay), (bx, by) = coords(a), coords(b)
+        return abs(ax - bx) + abs(ay - by)
+
+    def weighted_median(values):
+        values.sort()
+        half = sum(w for _, w in values) / 2.0
+        acc = 0
+        for v, w in values:
+            acc += w
+            if acc >= half:
+                return v
+        return values[-1][0]
+
+    # Even spread: k points on a near square grid of the mesh
+    grid_x = max(1, int(round((k * num_columns / num_rows) ** 0.5)))
+    grid_y = (k + grid_x - 1) // grid_x
+    hybrids = []
+    for i in range(k):
+        gx, gy = i % grid_x, i // grid_x
+        x = int((gx + 0.5) * num_columns / grid_x)
+        y = int((gy + 0.5) * num_rows / grid_y)
+        hybrids.append(min(y, num_rows - 1) * num_columns
+                       + min(x, num_columns - 1))
+    hybrids = list(dict.fromkeys(hybrids))
+    for r in range(num_routers):
+        if len(hybrids) == k:
+            break
+        if r not in hybrids:
+            hybrids.append(r)
+
+    for _ in range(32):
+        clusters = [[] for _ in hybrids]
+        for r in range(num_routers):
+            nearest = min(range(k), key=lambda i: hops(r, hybrids[i]))
+            clusters[nearest].append(r)
+
+        moved = []
+        for i, cluster in enumerate(clusters):
+            if not cluster or sum(weights[r] for r in cluster) == 0:
+                moved.append(hybrids[i])
+                continue
+            x = weighted_median([(coords(r)[0], weights[r]) for r in cluster])
+            y = weighted_median([(coords(r)[1], weights[r]) for r in cluster])
+            h = y * num_columns + x
+            moved.append(h if h not in moved else hybrids[i])
+        if moved == hybrids:
+            break
+        hybrids = moved
+
+    if num_routers <= 256:
+        best = hybrid_hops(num_rows, num_columns, hybrids, traffic)
+        improved = True
+        while improved:
+            improved = False
+            for i in range(k):
+                x, y = coords(hybrids[i])
+                for (dx, dy) in ((1, 0), (-1, 0), (0, 1), (0, -1)):
+                    nx, ny = x + dx, y + dy
+                    if not (0 <= nx < num_columns and 0 <= ny < num_rows):
+                        continue
+                    candidate = ny * num_columns + nx
+                    if candidate in hybrids:
+                        continue
+                    trial = hybrids[:i] + [candidate] + hybrids[i + 1 :]
+                    cost = hybrid_hops(num_rows, num_columns, trial, traffic)
+                    if cost < best:
+                        best, hybrids, improved = cost, trial, True
+                        break
+
+    return sorted(hybrids)
+
 # Creates a generic Mesh assuming an equal number of cache
 # and directory controllers.
 # XY routing is enforced (using link weights)
@@ -194,31 +348,98 @@ class Wireless_Mesh_XY(SimpleTopology):
                             weight=2,
                         )
                     )
-                    print(routers[south_out],routers[north_in])
                     link_count += 1
-        # wireless_routers=[18,45,50,21]
-        wireless_routers=options.hybrid_routers
-        for i in range(len(wireless_routers)):
-            for j in range(len(wireless_routers)):
-                if(i!=j):
-                    src_node=routers[wireless_routers[i]]
-                    dest_node=routers[wireless_routers[j]]
-                    int_links.append(
-                        IntLink(
-                            link_id=link_count,
-                            src_node=src_node,
-                            dst_node=dest_node,
-                            src_outport="Wireless_Out"+str(wireless_routers[j]),
-                            dst_inport="Wireless_In",
-                            latency=link_latency,
-                            weight=2,
-                        )
+        # Pick the hybrid routers if they were not given
+        if not options.hybrid_routers and options.num_hybrid_routers > 0:
+            traffic = None
+            if options.hybrid_placement_traffic:
+                traffic = read_traffic_matrix(
+                    options.hybrid_placement_traffic, num_routers
+                )
+            options.hybrid_routers = place_hybrid_routers(
+                num_rows, num_columns, options.num_hybrid_routers, traffic
+            )
+            inform(
+                "Hybrid routers placed at %s (average hops %.2f)"
+                % (
+                    options.hybrid_routers,
+                    hybrid_hops(
+                        num_rows, num_columns, options.hybrid_routers, traffic
+                    ),
+                )
+            )
+
+        # Shared wireless channels among the hybrid routers. Every hybrid
+        # router gets a transmit port onto each channel and a receive
+        # link (with its credit link) back from it, or one per other
+        # hybrid router with --wireless-rx-per-source. All hybrid routers
+        # have a transceiver on every channel, unless
+        # --wireless-channel-routers gives the routers of each channel.
+        wireless_routers = options.hybrid_routers
+        channel_routers = options.wireless_channel_routers
+        if not channel_routers:
+            channel_routers = [wireless_routers] * (
+                options.num_wireless_channels
+            )
+        if len(channel_routers) != options.num_wireless_channels:
+            fatal(
+                "--wireless-channel-routers lists %d channels, "
+                "--num-wireless-channels is %d"
+                % (len(channel_routers), options.num_wireless_channels)
+            )
+        for c, group in enumerate(channel_routers):
+            if len(set(group)) != len(group) or not set(group) <= set(
+                wireless_routers
+            ):
+                fatal(
+                    "Wireless channel %d routers %s are not distinct "
+                    "hybrid routers" % (c, group)
+                )
+
+        # The hybrid routers, where the wireless traffic queues, can be
+        # provisioned with more VCs and deeper buffers than the mesh
+        if options.network == "garnet":
+            for r in wireless_routers:
+                if options.hybrid_vcs_per_vnet > 0:
+                    routers[r].vcs_per_vnet = options.hybrid_vcs_per_vnet
+                if options.hybrid_buffers_per_data_vc > 0:
+                    routers[r].buffers_per_data_vc = (
+                        options.hybrid_buffers_per_data_vc
+                    )
+                if options.hybrid_buffers_per_ctrl_vc > 0:
+                    routers[r].buffers_per_ctrl_vc = (
+                        options.hybrid_buffers_per_ctrl_vc
                     )
-                    print("Wireless links")
-                    print("Srcport : Wireless_Out"+str(dest_node))
-                    print("Srcport : Wireless_In"+str(src_node))
-                    print(dest_node,src_node)
-                    link_count +=1
+                routers[r].wireless_buffers_per_data_vc = (
+                    options.wireless_buffers_per_data_vc
+                )
+                routers[r].wireless_buffers_per_ctrl_vc = (
+                    options.wireless_buffers_per_ctrl_vc
+                )
+
+        if options.network == "garnet" and len(wireless_routers) > 1:
+            wireless_channels = []
+            for c, group in enumerate(channel_routers):
+                rx_ports = len(group)
+                if options.wireless_rx_per_source:
+                    rx_ports *= len(group) - 1
+                rx_links = []
+                rx_credit_links = []
+                for p in range(rx_ports):
+                    rx_links.append(NetworkLink(link_id=link_count))
+                    rx_credit_links.append(CreditLink(link_id=link_count))
+                    link_count += 1
+                wireless_channels.append(
+                    WirelessChannel(
+                        channel_id=c,
+                        hybrid_routers=[routers[r] for r in group],
+                        rx_port_per_source=options.wireless_rx_per_source,
+                        rx_links=rx_links,
+                        rx_credit_links=rx_credit_links,
+                        latency=link_latency,
+                    )
+                )
+            network.wireless_channels = wireless_channels
 
         network.int_links = int_links
 
@@ -0,0 +1,385 @@
+# Copyright (c) 2024 The gem5_garnet_wireless authors
+# All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions are
+# met: redistributions of source code must retain the above copyright
+# notice, this list of conditions and the following disclaimer;
+# redistributions in binary form must reproduce the above copyright
+# notice, this list of conditions and the following disclaimer in the
+# documentation and/or other materials provided with the distribution;
+# neither the name of the copyright holders nor the names of its
+# contributors may be used to endorse or promote products derived from
+# this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+# "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+# LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+# A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+# OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+# SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+# LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+# DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+# THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+"""Synthetic-traffic benchmark of the wireless mesh: latency and
+throughput curves and simulator speed.
+
+Sweeps injection rate, traffic pattern, mesh size and hybrid router
+count with garnet_synth_traffic.py on Wireless_Mesh_XY, running the
+points in parallel as garnet_sweep.py does. uniform_random, transpose
+and bit_complement use the synthetic traffic generator. hotspot_hybrid
+sends --hotspot-fraction of the packets to the routers with a wireless
+transceiver; it is replayed as a traffic trace (--garnet-traffic-trace),
+since the generator has no such pattern.
+
+Every point gets explicit hybrid routers (placed as
+Wireless_Mesh_XY.py would), so results.csv and results.json can be
+diffed across commits. Example (run with the host python from the gem5
+directory):
+
+    python3 configs/garnet_benchmark.py --gem5=build/NULL/gem5.opt \\
+        --outdir=bench --rows 4 8 --hybrids 4 \\
+        -- --routing-algorithm=2 --vcs-per-vnet=4
+
+Options after '--' are passed to every run.
+"""
+
+import argparse
+import csv
+import importlib.util
+import json
+import os
+import random
+import re
+import struct
+import sys
+import types
+from concurrent.futures import ThreadPoolExecutor
+
+sys.path.insert(0, os.path.dirname(os.path.abspath(__file__)))
+from garnet_sweep import point_dir, run_point
+
+PATTERNS = ["uniform_random", "transpose", "bit_complement", "hotspot_hybrid"]
+
+# TrafficTraceRecord: tick, src NI, dest NI, vnet, size in bytes
+TRACE_RECORD = struct.Struct("<QIIII")
+
+
+def find_topology(topology_file=None):
+    """Path of Wireless_Mesh_XY.py: topology_file if given, else next
+    to this script, then in configs/topologies/ (None if not found)."""
+    if topology_file is not None:
+        return topology_file
+    here = os.path.dirname(os.path.abspath(__file__))
+    for candidate in [
+        os.path.join(here, "Wireless_Mesh_XY.py"),
+        os.path.join("configs", "topologies", "Wireless_Mesh_XY.py"),
+    ]:
+        if os.path.exists(candidate):
+            return candidate
+    return None
+
+
+def load_topology(topology_file):
+    """Wireless_Mesh_XY.py as a module, loaded without gem5 (its gem5
+    imports are replaced with empty modules)."""
+
+    def fatal(msg, *args):
+        raise SystemExit(msg % args)
+
+    stubs = {}
+    for name in [
+        "m5",
+        "m5.params",
+        "m5.objects",
+        "m5.util",
+        "common",
+        "topologies",
+        "topologies.BaseTopology",
+    ]:
+        stubs[name] = types.ModuleType(name)
+    stubs["m5.util"].fatal = fatal
+    stubs["m5.util"].inform = lambda *args: None
+    stubs["common"].FileSystemConfig = None
+    stubs["topologies.BaseTopology"].SimpleTopology = object
+
+    saved = {name: sys.modules.get(name) for name in stubs}
+    sys.modules.update(stubs)
+    try:
+        spec = importlib.util.spec_from_file_location(
+            "Wireless_Mesh_XY", topology_file
+        )
+        module = importlib.util.module_from_spec(spec)
+        spec.loader.exec_module(module)
+    finally:
+        for name, old in saved.items():
+            if old is None:
+                del sys.modules[name]
+            else:
+                sys.modules[name] = old
+    return module
+
+
+def load_placement(topology_file):
+    """place_hybrid_routers() of Wireless_Mesh_XY.py."""
+    return load_topology(topology_file).place_hybrid_routers
+
+
+def write_hotspot_trace(path, rows, hybrids, rate, cycles, fraction, seed,
+                        cycle_ticks):
+    """Bernoulli injection of single-flit control packets from every
+    CPU NI: fraction of them go to the directory of a random hybrid
+    router, the others to a random directory. Garnet_standalone
+    numbers the CPU NIs 0..n-1 and the directory NIs n..2n-1, one of
+    each per router."""
+    num_routers = rows * rows
+    rng = random.Random(seed)
+    with open(path, "wb") as trace:
+        for cycle in range(cycles):
+            for src in range(num_routers):
+                if rng.random() >= rate:
+                    continue
+                if rng.random() < fraction:
+                    dest = rng.choice(hybrids)
+                else:
+                    dest = rng.randrange(num_routers)
+                trace.write(
+                    TRACE_RECORD.pack(
+                        cycle * cycle_ticks, src, num_routers + dest, 0, 8
+                    )
+                )
+
+
+def read_dump(stats_file):
+    """First dump of stats_file as {name: [values]} ({} if missing)."""
+    stats = {}
+    if not os.path.exists(stats_file):
+        return stats
+    with open(stats_file) as dump:
+        for line in dump:
+            if line.startswith("---------- End"):
+                break
+            fields = line.split("#")[0].split()
+            if len(fields) >= 2:
+                stats[fields[0]] = fields[1:]
+    return stats
+
+
+def number(stats, name):
+    try:
+        return float(stats[name][0])
+    except (KeyError, ValueError, IndexError):
+        return None
+
+
+def latency_percentile(stats, percentile):
+    """Upper edge of the bucket reaching percentile of the packets in
+    the wired and wireless packet latency histograms of all vnets."""
+    bucket = re.compile(
+        r"\.(?:wired|wireless)_packet_latency\.vnet-\d+::(\d+)-(\d+)$"
+    )
+    buckets = []
+    for name, values in stats.items():
+        match = bucket.search(name)
+        if match:
+            buckets.append((int(match.group(2)), int(values[0])))
+    total = sum(count for _, count in buckets)
+    if total == 0:
+        return None
+    seen = 0
+    for high, count in sorted(buckets):
+        seen += count
+        if seen >= percentile / 100.0 * total:
+            return high
+    return None
+
+
+def summarize(stats, num_sources, cycles):
+    """Benchmark metrics of one point from its stats."""
+    net = "system.ruby.network."
+    received = number(stats, net + "packets_received::total")
+    utilization = [
+        float(values[0])
+        for name, values in stats.items()
+        if re.match(re.escape(net) + r"wireless_channels\d*\.utilization$",
+                    name)
+    ]
+    return {
+        "avg_packet_latency": number(stats, net + "average_packet_latency"),
+        "p99_packet_latency": latency_percentile(stats, 99),
+        "accepted_throughput": (
+            received / (num_sources * cycles) if received is not None
+            else None
+        ),
+        "wireless_utilization": (
+            sum(utilization) / len(utilization) if utilization else None
+        ),
+        "wireless_packet_fraction": number(
+            stats, net + "wireless_packet_fraction"
+        ),
+        "sim_ticks_per_second": number(stats, "hostTickRate"),
+    }
+
+
+def benchmark_point(options, place, extra_args, index, point):
+    """Runs one point. Returns its results row."""
+    rows, hybrids, pattern, rate = point
+    outdir = point_dir(
+        options.outdir,
+        index,
+        [("rows", rows), ("hybrids", hybrids), (pattern, rate)],
+    )
+    os.makedirs(outdir, exist_ok=True)
+    hybrid_routers = place(rows, rows, hybrids) if hybrids else []
+
+    args = [options.script, "--network=garnet",
+            "--topology=Wireless_Mesh_XY"]
+    args += [f"--mesh-rows={rows}", f"--num-cpus={rows * rows}",
+             f"--num-dirs={rows * rows}", f"--sim-cycles={options.cycles}"]
+    if hybrid_routers:
+        args.append("--hybrid-routers=" + ",".join(map(str, hybrid_routers)))
+    if pattern == "hotspot_hybrid":
+        trace = os.path.abspath(os.path.join(outdir, "traffic.trace"))
+        write_hotspot_trace(trace, rows, hybrid_routers or [0], rate,
+                            options.cycles, options.hotspot_fraction,
+                            options.seed, options.cycle_ticks)
+        args += ["--injectionrate=0", f"--garnet-traffic-trace={trace}"]
+    else:
+        args += [f"--synthetic={pattern}", f"--injectionrate={rate}"]
+    args += extra_args
+
+    result = run_point(options.gem5, args, outdir, [], [])
+    row = {
+        "rows": rows,
+        "hybrids": hybrids,
+        "hybrid_routers": ",".join(map(str, hybrid_routers)),
+        "pattern": pattern,
+        "injection_rate": rate,
+        "exit_code": result["exit_code"],
+        "wall_seconds": result["wall_seconds"],
+    }
+    row.update(
+        summarize(read_dump(os.path.join(outdir, "stats.txt")),
+                  rows * rows, options.cycles)
+    )
+    return row
+
+
+def main():
+    parser = argparse.ArgumentParser(
+        description=__doc__.splitlines()[0],
+        usage="%(prog)s [options] [-- <options passed to every run>]",
+    )
+    parser.add_argument("--gem5", required=True, help="gem5 binary")
+    parser.add_argument(
+        "--script",
+        default="configs/example/garnet_synth_traffic.py",
+        help="synthetic traffic config script",
+    )
+    parser.add_argument(
+        "--topology-file",
+        default=None,
+        help="Wireless_Mesh_XY.py used to place the hybrid routers "
+        "(default: next to this script, then configs/topologies/)",
+    )
+    parser.add_argument(
+        "--jobs",
+        type=int,
+        default=os.cpu_count(),
+        help="simulations run at the same time (default: host cores)",
+    )
+    parser.add_argument("--outdir", default="bench", help="output directory")
+    parser.add_argument(
+        "--rates",
+        nargs="+",
+        type=float,
+        default=[0.02, 0.05, 0.1, 0.15, 0.2, 0.3],
+        help="injection rates (packets/node/cycle)",
+    )
+    parser.add_argument(
+        "--patterns", nargs="+", choices=PATTERNS, default=PATTERNS
+    )
+    parser.add_argument(
+        "--rows", nargs="+", type=int, default=[4, 8], help="mesh sizes"
+    )
+    parser.add_argument(
+        "--hybrids",
+        nargs="+",
+        type=int,
+        default=[4],
+        help="hybrid router counts (0: wired mesh)",
+    )
+    parser.add_argument("--cycles", type=int, default=20000)
+    parser.add_argument(
+        "--hotspot-fraction",
+        type=float,
+        default=0.5,
+        help="share of the hotspot_hybrid packets sent to hybrid routers",
+    )
+    parser.add_argument(
+        "--seed", type=int, default=1, help="seed of the hotspot traces"
+    )
+    parser.add_argument(
+        "--cycle-ticks",
+        type=int,
+        default=1000,
+        help="ticks per network cycle, for the hotspot traces",
+    )
+
+    argv = sys.argv[1:]
+    extra_args = []
+    if "--" in argv:
+        split = argv.index("--")
+        argv, extra_args = argv[:split], argv[split + 1 :]
+    options = parser.parse_args(argv)
+
+    topology_file = find_topology(options.topology_file)
+    if topology_file is None:
+        parser.error("Wireless_Mesh_XY.py not found, use --topology-file")
+    place = load_placement(topology_file)
+
+    points = [
+        (rows, hybrids, pattern, rate)
+        for rows in options.rows
+        for hybrids in options.hybrids
+        for pattern in options.patterns
+        for rate in options.rates
+    ]
+    os.makedirs(options.outdir, exist_ok=True)
+    with ThreadPoolExecutor(max_workers=max(1, options.jobs)) as pool:
+        results = list(
+            pool.map(
+                lambda indexed: benchmark_point(
+                    options, place, extra_args, *indexed
+                ),
+                enumerate(points),
+            )
+        )
+
+    with open(os.path.join(options.outdir, "results.csv"), "w",
+              newline="") as out:
+        writer = csv.DictWriter(out, fieldnames=list(results[0]))
+        writer.writeheader()
+        writer.writerows(results)
+    with open(os.path.join(options.outdir, "results.json"), "w") as out:
+        json.dump(
+            {"extra_args": extra_args, "cycles": options.cycles,
+             "seed": options.seed, "points": results},
+            out,
+            indent=1,
+            sort_keys=True,
+        )
+
+    failed = [row for row in results if row["exit_code"] != 0]
+    print(
+        f"{len(results)} points, {len(failed)} failed, results in "
+        f"{os.path.join(options.outdir, 'results.csv')} and results.json"
+    )
+    return 1 if failed else 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
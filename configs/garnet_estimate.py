@@ -0,0 +1,438 @@
+# Copyright (c) 2024 The gem5_garnet_wireless authors
+# All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions are
+# met: redistributions of source code must retain the above copyright
+# notice, this list of conditions and the following disclaimer;
+# redistributions in binary form must reproduce the above copyright
+# notice, this list of conditions and the following disclaimer in the
+# documentation and/or other materials provided with the distribution;
+# neither the name of the copyright holders nor the names of its
+# contributors may be used to endorse or promote products derived from
+# this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+# "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+# LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+# A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+# OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+# SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+# LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+# DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+# THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+"""Analytical estimate of the packet latency of the wireless mesh, to
+prune a design space before running it with Garnet.
+
+For every mesh size, hybrid router count and placement, traffic
+pattern, injection rate, token mode and channel count, the packets of
+every router pair take the route the custom routing algorithm
+(RoutingUnit::searchHybridRoute) picks at the source: the XY path, or
+XY to a hybrid router, one wireless hop and XY to the destination when
+that has fewer hops. The routes give the load of every directed link
+and of every hybrid transmitter, and each link, transmitter and
+channel is modelled as an M/D/1 queue serving one flit per cycle:
+
+  - wired hop: router_latency + link_latency cycles, plus the M/D/1
+    wait rho / (2 (1 - rho)) of the link;
+  - wireless hop: wireless_latency cycles plus the token wait. In
+    rotate mode the token reaches a transmitter every H cycles (H
+    hybrid routers), so its queue serves one flit per H cycles:
+    (H - 1) / 2 + rho H / (2 (1 - rho)) with rho = load H. In demand
+    mode the transmitters share the channel: 1 + rho / (2 (1 - rho))
+    with rho the channel load. The traffic of a hybrid router is
+    spread over the channels, and a packet keeps the token for all
+    its flits.
+
+A configuration saturates if any of these loads reaches 1. Placements
+are those of Wireless_Mesh_XY.py (place_hybrid_routers) and, with
+--random-placements, random ones. The configurations within
+--keep of the lowest estimated latency of their mesh size, pattern and
+rate are reported as worth a full Garnet run. Example:
+
+    python3 configs/garnet_estimate.py --rows 8 16 --hybrids 4 8 16 \\
+        --random-placements 20 --rates 0.02 0.05 --out=estimate.csv
+
+The routes are computed once per placement and pattern; each rate,
+token mode and channel count then only sums over the links. Self
+traffic and the NI queues are not modelled, and ties between routes
+go to the lowest hybrid router ids.
+"""
+
+import argparse
+import csv
+import itertools
+import os
+import random
+import sys
+import time
+
+sys.path.insert(0, os.path.dirname(os.path.abspath(__file__)))
+from garnet_benchmark import PATTERNS, find_topology, load_topology
+
+INF = float("inf")
+
+
+def traffic_entries(pattern, rows, hybrids, fraction):
+    """[(src, dest, share)] of the packets of a router for pattern in
+    a rows x rows mesh, as the synthetic traffic generator sends them
+    (the shares of a source sum to 1 before self traffic is dropped)."""
+    n = rows * rows
+    entries = []
+    for src in range(n):
+        x, y = src % rows, src // rows
+        if pattern == "uniform_random":
+            entries += [(src, dst, 1.0 / n) for dst in range(n)]
+        elif pattern == "transpose":
+            entries.append((src, x * rows + y, 1.0))
+        elif pattern == "bit_complement":
+            entries.append((src, (rows - 1 - y) * rows + rows - 1 - x, 1.0))
+        else:
+            entries += [(src, dst, (1 - fraction) / n) for dst in range(n)]
+            entries += [(src, h, fraction / len(hybrids)) for h in hybrids]
+    return [(src, dst, share) for src, dst, share in entries if src != dst]
+
+
+def matrix_entries(traffic):
+    """traffic_entries() of a router to router packet count matrix,
+    scaled to an average of 1 packet per source."""
+    n = len(traffic)
+    total = sum(
+        traffic[src][dst] for src in range(n) for dst in range(n) if src != dst
+    )
+    if total == 0:
+        raise SystemExit("The traffic matrix is empty")
+    return [
+        (src, dst, traffic[src][dst] * n / total)
+        for src in range(n)
+        for dst in range(n)
+        if src != dst and traffic[src][dst]
+    ]
+
+
+def mdl_wait(rho):
+    """M/D/1 queueing delay (in service times) at utilization rho."""
+    return rho / (2 * (1 - rho)) if rho < 1 else INF
+
+
+class Mesh:
+    """Directed link loads of a rows x rows mesh: XY paths are added
+    as one horizontal and one vertical segment of difference arrays."""
+
+    def __init__(self, rows):
+        self.rows = rows
+        self.loads = {d: [[0.0] * rows for _ in range(rows)] for d in "EWNS"}
+
+    def hops(self, a, b):
+        r = self.rows
+        return abs(a % r - b % r) + abs(a // r - b // r)
+
+    def add_path(self, a, b, load):
+        """Adds load to the links of the XY path from a to b: links
+        start..end-1 of a row (E, W), then of a column (N, S)."""
+        r = self.rows
+        ax, ay, bx, by = a % r, a // r, b % r, b // r
+        segments = []
+        if bx != ax:
+            segments.append(("E" if bx > ax else "W", ay, ax, bx))
+        if by != ay:
+            segments.append(("N" if by > ay else "S", bx, ay, by))
+        for d, line, start, end in segments:
+            start, end = min(start, end), max(start, end)
+            self.loads[d][line][start] += load
+            self.loads[d][line][end] -= load
+
+    def link_loads(self):
+        """Load of every link, from the difference arrays."""
+        result = []
+        for lines in self.loads.values():
+            for line in lines:
+                load = 0.0
+                for i in range(self.rows - 1):
+                    load += line[i]
+                    result.append(load)
+        return result
+
+
+def nearest_hybrids(mesh, hybrids, router):
+    """The two (hops, hybrid router) closest to router."""
+    return sorted((mesh.hops(router, h), h) for h in hybrids)[:2]
+
+
+def hybrid_route(mesh, hybrids, nearest, src, dst):
+    """(wired hops, src hybrid, dest hybrid) of the route picked by
+    RoutingUnit::searchHybridRoute, hybrids None on the XY path.
+    nearest[r] holds the two hybrid routers closest to r, among which
+    the best pair of distinct hybrid routers is always found."""
+    xy_hops = mesh.hops(src, dst)
+    candidates = [(0, src)] if src in hybrids else nearest[src]
+    best = (INF, None, None)
+    for to_hybrid, h1 in candidates:
+        # The closest hybrid router to dst other than h1
+        from_hybrid, h2 = next(c for c in nearest[dst] if c[1] != h1)
+        if to_hybrid + from_hybrid < best[0]:
+            best = (to_hybrid + from_hybrid, h1, h2)
+    return best if best[0] + 1 < xy_hops else (xy_hops, None, None)
+
+
+class Routes:
+    """Routes of a traffic pattern over a placement, for one packet
+    injected per source and cycle: the packets crossing every link and
+    sent by every hybrid router, and the latency of the packets
+    without queueing."""
+
+    def __init__(self, rows, hybrids, entries, options):
+        start = time.perf_counter()
+        mesh = Mesh(rows)
+        hybrid_set = set(hybrids)
+        nearest = [
+            nearest_hybrids(mesh, hybrids, r) for r in range(rows * rows)
+        ]
+        self.tx = dict.fromkeys(hybrids, 0.0)
+        self.weight = self.hops = self.wireless = self.cycles = 0.0
+        for src, dst, share in entries:
+            if len(hybrids) >= 2:
+                wired, h1, h2 = hybrid_route(
+                    mesh, hybrid_set, nearest, src, dst
+                )
+            else:
+                wired, h1, h2 = mesh.hops(src, dst), None, None
+
+            self.weight += share
+            cycles = wired * options.link_latency
+            cycles += options.flits_per_packet - 1
+            if h1 is None:
+                mesh.add_path(src, dst, share)
+                self.hops += share * wired
+                cycles += (wired + 1) * options.router_latency
+            else:
+                mesh.add_path(src, h1, share)
+                mesh.add_path(h2, dst, share)
+                self.tx[h1] += share
+                self.wireless += share
+                self.hops += share * (wired + 1)
+                cycles += (wired + 2) * options.router_latency
+                cycles += options.wireless_latency
+            self.cycles += share * cycles
+        self.links = mesh.link_loads()
+        self.ms = (time.perf_counter() - start) * 1000
+
+
+def estimate(routes, num_hybrids, rate, token_mode, channels, options):
+    """Estimate of one configuration as columns of the results CSV.
+    Every packet waits at each link and transmitter it crosses, so the
+    total wait is the sum of the waits weighted by the packets crossing
+    them."""
+    start = time.perf_counter()
+    flits = rate * options.flits_per_packet
+
+    max_link = max(routes.links, default=0.0) * flits
+    wait = sum(u * mdl_wait(u * flits) for u in routes.links if u > 0)
+
+    tx_load = {h: u * flits / channels for h, u in routes.tx.items()}
+    if token_mode == "rotate":
+        max_wireless = max(tx_load.values(), default=0.0) * num_hybrids
+        for h, load in tx_load.items():
+            if routes.tx[h] > 0:
+                wait += routes.tx[h] * (
+                    (num_hybrids - 1) / 2
+                    + num_hybrids * mdl_wait(load * num_hybrids)
+                )
+    else:
+        max_wireless = sum(tx_load.values(), 0.0)
+        wait += routes.wireless * (1 + mdl_wait(max_wireless))
+
+    saturated = max_link >= 1 or max_wireless >= 1
+    latency = INF if saturated else (routes.cycles + wait) / routes.weight
+    return {
+        "latency": round(latency, 3),
+        "saturated": int(saturated),
+        "avg_hops": round(routes.hops / routes.weight, 3),
+        "wireless_fraction": round(routes.wireless / routes.weight, 4),
+        "max_link_load": round(max_link, 4),
+        "max_wireless_load": round(max_wireless, 4),
+        "routing_ms": round(routes.ms, 3),
+        "ms": round((time.perf_counter() - start) * 1000, 3),
+    }
+
+
+def placements(place, rows, count, num_random, rng):
+    """[(label, hybrids)]: the Wireless_Mesh_XY.py placement, then
+    num_random random ones."""
+    if count == 0:
+        return [("none", [])]
+    result = [("kmedians", place(rows, rows, count))]
+    for i in range(num_random):
+        result.append(
+            (f"random{i}", sorted(rng.sample(range(rows * rows), count)))
+        )
+    return result
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument(
+        "--topology-file",
+        default=None,
+        help="Wireless_Mesh_XY.py used to place the hybrid routers "
+        "(default: next to this script, then configs/topologies/)",
+    )
+    parser.add_argument("--out", default="estimate.csv", help="results CSV")
+    parser.add_argument(
+        "--rows", nargs="+", type=int, default=[4, 8], help="mesh sizes"
+    )
+    parser.add_argument(
+        "--hybrids",
+        nargs="+",
+        type=int,
+        default=[4],
+        help="hybrid router counts (0: wired mesh)",
+    )
+    parser.add_argument(
+        "--random-placements",
+        type=int,
+        default=0,
+        help="random placements per hybrid count, besides the default one",
+    )
+    parser.add_argument(
+        "--patterns", nargs="+", choices=PATTERNS, default=PATTERNS
+    )
+    parser.add_argument(
+        "--traffic-matrix",
+        default=None,
+        help="stats.txt of a previous run: its traffic_distribution is "
+        "used instead of --patterns",
+    )
+    parser.add_argument(
+        "--rates",
+        nargs="+",
+        type=float,
+        default=[0.02, 0.05, 0.1],
+        help="injection rates (packets/node/cycle)",
+    )
+    parser.add_argument(
+        "--token-modes",
+        nargs="+",
+        choices=["rotate", "demand"],
+        default=["rotate", "demand"],
+    )
+    parser.add_argument(
+        "--channels",
+        nargs="+",
+        type=int,
+        default=[1],
+        help="wireless channel counts",
+    )
+    parser.add_argument("--flits-per-packet", type=int, default=1)
+    parser.add_argument("--router-latency", type=int, default=1)
+    parser.add_argument("--link-latency", type=int, default=1)
+    parser.add_argument("--wireless-latency", type=int, default=1)
+    parser.add_argument(
+        "--hotspot-fraction",
+        type=float,
+        default=0.5,
+        help="share of the hotspot_hybrid packets sent to hybrid routers",
+    )
+    parser.add_argument(
+        "--keep",
+        type=float,
+        default=0.1,
+        help="report the configurations within this fraction of the "
+        "best latency of their mesh size, pattern and rate",
+    )
+    parser.add_argument("--seed", type=int, default=1)
+    options = parser.parse_args()
+
+    topology_file = find_topology(options.topology_file)
+    if topology_file is None:
+        parser.error("Wireless_Mesh_XY.py not found, use --topology-file")
+    topology = load_topology(topology_file)
+    rng = random.Random(options.seed)
+
+    results = []
+    for rows in options.rows:
+        if options.traffic_matrix:
+            traffic = topology.read_traffic_matrix(
+                options.traffic_matrix, rows * rows
+            )
+            patterns = [("matrix", matrix_entries(traffic))]
+        else:
+            patterns = [(pattern, None) for pattern in options.patterns]
+        for count in options.hybrids:
+            for label, hybrids in placements(
+                topology.place_hybrid_routers,
+                rows,
+                count,
+                options.random_placements,
+                rng,
+            ):
+                for pattern, entries in patterns:
+                    if entries is None:
+                        entries = traffic_entries(
+                            pattern,
+                            rows,
+                            hybrids or [0],
+                            options.hotspot_fraction,
+                        )
+                    routes = Routes(rows, hybrids, entries, options)
+                    for rate, token_mode, channels in itertools.product(
+                        options.rates, options.token_modes, options.channels
+                    ):
+                        row = {
+                            "rows": rows,
+                            "hybrids": count,
+                            "placement": label,
+                            "hybrid_routers": ",".join(map(str, hybrids)),
+                            "pattern": pattern,
+                            "rate": rate,
+                            "token_mode": token_mode,
+                            "channels": channels,
+                        }
+                        row.update(
+                            estimate(routes, count, rate, token_mode,
+                                     channels, options)
+                        )
+                        results.append(row)
+
+    best = {}
+    for row in results:
+        key = (row["rows"], row["pattern"], row["rate"])
+        best[key] = min(best.get(key, INF), row["latency"])
+    for row in results:
+        key = (row["rows"], row["pattern"], row["rate"])
+        row["candidate"] = int(
+            row["latency"] != INF
+            and row["latency"] <= best[key] * (1 + options.keep)
+        )
+
+    with open(options.out, "w", newline="") as out:
+        writer = csv.DictWriter(out, fieldnames=list(results[0]))
+        writer.writeheader()
+        writer.writerows(results)
+
+    candidates = [row for row in results if row["candidate"]]
+    for row in candidates:
+        print(
+            f"{row['rows']}x{row['rows']} {row['pattern']} "
+            f"rate={row['rate']}: {row['latency']} cycles "
+            f"--hybrid-routers={row['hybrid_routers']} "
+            f"--wireless-token-mode={row['token_mode']} "
+            f"--num-wireless-channels={row['channels']}"
+        )
+    total_ms = sum(row["ms"] for row in results)
+    total_ms += sum(
+        {(r["rows"], r["placement"], r["hybrids"], r["pattern"]):
+         r["routing_ms"] for r in results}.values()
+    )
+    print(
+        f"{len(results)} configurations in {total_ms:.0f} ms, "
+        f"{len(candidates)} worth a full run, results in {options.out}"
+    )
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
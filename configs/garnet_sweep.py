@@ -0,0 +1,196 @@
+# Copyright (c) 2024 The gem5_garnet_wireless authors
+# All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions are
+# met: redistributions of source code must retain the above copyright
+# notice, this list of conditions and the following disclaimer;
+# redistributions in binary form must reproduce the above copyright
+# notice, this list of conditions and the following disclaimer in the
+# documentation and/or other materials provided with the distribution;
+# neither the name of the copyright holders nor the names of its
+# contributors may be used to endorse or promote products derived from
+# this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+# "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+# LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+# A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+# OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+# SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+# LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+# DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+# THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+"""Runs the points of a design-space sweep as independent gem5
+processes, one per host core, and gathers selected stats in a CSV.
+
+The simulator is not split across threads. The flit pool is thread
+local and the NIs could share their router's event queue shard, but
+Ruby assumes a single event queue (Consumer wakeups, message buffers,
+the stats), and WirelessChannel checks the receive credits of the
+other hybrid routers synchronously, inside the sender's cycle. The
+idle cores are therefore used across simulations, not within one.
+
+Example (run with the host python, not with gem5):
+
+    python3 configs/garnet_sweep.py --gem5=build/NULL/gem5.opt \\
+        --jobs=64 --outdir=sweep \\
+        --sweep injectionrate 0.02 0.06 0.10 \\
+        --sweep hybrid-routers 18,21,45,50 9,14,49,54 \\
+        --stat system.ruby.network.average_packet_latency \\
+        -- configs/example/garnet_synth_traffic.py --network=garnet \\
+        --topology=Wireless_Mesh_XY --mesh-rows=8 --num-cpus=64 ...
+
+Every sweep value is passed to the script as --<name>=<value>.
+"""
+
+import argparse
+import csv
+import itertools
+import os
+import re
+import subprocess
+import sys
+import time
+from concurrent.futures import ThreadPoolExecutor
+
+
+def sweep_points(axes):
+    """Cartesian product of [(name, [values])] as a list of
+    [(name, value)]."""
+    names = [name for name, _ in axes]
+    return [
+        list(zip(names, values))
+        for values in itertools.product(*[values for _, values in axes])
+    ]
+
+
+def point_dir(outdir, index, point):
+    label = "_".join(f"{name}-{value}" for name, value in point)
+    label = re.sub(r"[^\w.-]", "", label)
+    return os.path.join(outdir, f"{index:04d}_{label}")
+
+
+def read_stats(stats_file, names):
+    """Values of the stats in names from the first dump of stats_file
+    (None if missing)."""
+    values = dict.fromkeys(names)
+    if not os.path.exists(stats_file):
+        return values
+    with open(stats_file) as stats:
+        for line in stats:
+            if line.startswith("---------- End"):
+                break
+            fields = line.split()
+            if len(fields) >= 2 and fields[0] in values:
+                values[fields[0]] = fields[1]
+    return values
+
+
+def run_point(gem5, script_args, outdir, point, stats):
+    """Runs one gem5 process. Returns the row of the results CSV."""
+    os.makedirs(outdir, exist_ok=True)
+    cmd = [gem5, f"--outdir={outdir}"]
+    cmd += ["--redirect-stdout", "--redirect-stderr"] + script_args
+    cmd += [f"--{name}={value}" for name, value in point]
+    start = time.time()
+    result = subprocess.run(cmd, stdin=subprocess.DEVNULL)
+    row = dict(point)
+    row["exit_code"] = result.returncode
+    row["wall_seconds"] = round(time.time() - start, 3)
+    row.update(read_stats(os.path.join(outdir, "stats.txt"), stats))
+    return row
+
+
+def run_sweep(gem5, script_args, axes, outdir, stats, jobs):
+    """Runs every point of the sweep with at most jobs processes at a
+    time and writes outdir/results.csv. Returns the rows."""
+    points = sweep_points(axes)
+    with ThreadPoolExecutor(max_workers=jobs) as pool:
+        rows = list(
+            pool.map(
+                lambda indexed: run_point(
+                    gem5,
+                    script_args,
+                    point_dir(outdir, *indexed),
+                    indexed[1],
+                    stats,
+                ),
+                enumerate(points),
+            )
+        )
+
+    fields = [name for name, _ in axes] + ["exit_code", "wall_seconds"]
+    fields += stats
+    with open(os.path.join(outdir, "results.csv"), "w", newline="") as out:
+        writer = csv.DictWriter(out, fieldnames=fields)
+        writer.writeheader()
+        writer.writerows(rows)
+    return rows
+
+
+def main():
+    parser = argparse.ArgumentParser(
+        description=__doc__.splitlines()[0],
+        usage="%(prog)s [options] -- <config script> [script options]",
+    )
+    parser.add_argument("--gem5", required=True, help="gem5 binary")
+    parser.add_argument(
+        "--jobs",
+        type=int,
+        default=os.cpu_count(),
+        help="simulations run at the same time (default: host cores)",
+    )
+    parser.add_argument("--outdir", default="sweep", help="output directory")
+    parser.add_argument(
+        "--sweep",
+        nargs="+",
+        action="append",
+        default=[],
+        metavar=("NAME", "VALUE"),
+        help="script option to sweep and its values (repeatable)",
+    )
+    parser.add_argument(
+        "--stat",
+        action="append",
+        default=[],
+        help="stat to collect from stats.txt (repeatable)",
+    )
+
+    argv = sys.argv[1:]
+    if "--" not in argv:
+        parser.error("missing '--' before the config script")
+    split = argv.index("--")
+    options = parser.parse_args(argv[:split])
+    script_args = argv[split + 1 :]
+    if not script_args:
+        parser.error("missing config script after '--'")
+
+    axes = []
+    for sweep in options.sweep:
+        if len(sweep) < 2:
+            parser.error(f"--sweep {sweep[0]} needs at least one value")
+        axes.append((sweep[0], sweep[1:]))
+
+    os.makedirs(options.outdir, exist_ok=True)
+    rows = run_sweep(
+        options.gem5,
+        script_args,
+        axes,
+        options.outdir,
+        options.stat,
+        max(1, options.jobs),
+    )
+    failed = [row for row in rows if row["exit_code"] != 0]
+    print(
+        f"{len(rows)} points, {len(failed)} failed, results in "
+        f"{os.path.join(options.outdir, 'results.csv')}"
+    )
+    return 1 if failed else 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
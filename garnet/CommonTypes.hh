@@ -49,9 +49,14 @@ enum flit_type {HEAD_, BODY_, TAIL_, HEAD_TAIL_,
 enum VC_state_type {IDLE_, VC_AB_, ACTIVE_, NUM_VC_STATE_TYPE_};
 enum VNET_type {CTRL_VNET_, DATA_VNET_, NULL_VNET_, NUM_VNET_TYPE_};
 enum flit_stage {I_, VA_, SA_, ST_, LT_, NUM_FLIT_STAGE_};
-enum link_type { EXT_IN_, EXT_OUT_, INT_, NUM_LINK_TYPES_ };
-enum RoutingAlgorithm { TABLE_ = 0, XY_ = 1, CUSTOM_ = 2,
+enum link_type { EXT_IN_, EXT_OUT_, INT_, WIRELESS_, NUM_LINK_TYPES_ };
+enum RoutingAlgorithm { TABLE_ = 0, XY_ = 1, CUSTOM_ = 2, ADAPTIVE_ = 3,
                         NUM_ROUTING_ALGORITHM_};
+// Port types resolved once from the PortDirection string when a port
+// is added to a router. The hot paths compare these instead of strings.
+enum PortType { LOCAL_PORT_, NORTH_PORT_, SOUTH_PORT_, EAST_PORT_,
+                WEST_PORT_, WIRELESS_IN_PORT_, WIRELESS_OUT_PORT_,
+                UNKNOWN_PORT_, NUM_PORT_TYPE_ };
 
 struct RouteInfo
 {
@@ -74,6 +79,10 @@ struct RouteInfo
 
 #define INFINITE_ 10000
 
+// Receiver (m_dest_wireless) of a packet broadcast on a wireless channel
+// to several hybrid routers
+#define WIRELESS_MULTICAST_ -2
+
 } // namespace garnet
 } // namespace ruby
 } // namespace gem5
@@ -42,20 +42,38 @@ namespace garnet
 {
 
 // Credit Signal for buffers inside VC
-// Carries m_vc (inherits from flit.hh)
-// and m_is_free_signal (whether VC is free or not)
+// Carries m_vc (inherits from flit.hh),
+// m_is_free_signal (whether VC is free or not)
+// and m_count (buffers freed, several credits of a VC may be coalesced)
 
-Credit::Credit(int vc, bool is_free_signal, Tick curTime)
-    : flit(0, 0, vc, 0, RouteInfo(), 0, nullptr, 0, 0, curTime)
+Credit::Credit(int vc, bool is_free_signal, Tick curTime, int count)
+    : flit(0, 0, vc, 0, nullptr, 0, 0, 0, curTime)
 {
     m_is_free_signal = is_free_signal;
+    m_count = count;
     m_type = CREDIT_;
 }
 
+void
+Credit::send(flitBuffer *credit_queue, int vc, bool is_free_signal,
+             Tick curTime, bool allow_coalesce)
+{
+    // A queued credit has not left yet, so the coalesced one
+    // leaves no earlier than it would have on its own
+    if (allow_coalesce && !credit_queue->isEmpty() &&
+        static_cast<Credit *>(credit_queue->peekBackFlit())->
+            coalesce(vc, is_free_signal)) {
+        return;
+    }
+    credit_queue->insert(new Credit(vc, is_free_signal, curTime));
+}
+
 flit *
 Credit::serialize(int ser_id, int parts, uint32_t bWidth)
 {
     DPRINTF(RubyNetwork, "Serializing a credit\n");
+    // SerDes converts credits one by one (see GarnetLink::init)
+    assert(m_count == 1);
     bool new_free = false;
     if ((ser_id+1 == parts) && m_is_free_signal) {
         new_free = true;
@@ -69,6 +87,7 @@ Credit::deserialize(int des_id, int num_flits, uint32_t bWidth)
 {
     DPRINTF(RubyNetwork, "DeSerializing a credit vc:%d free:%d\n",
     m_vc, m_is_free_signal);
+    assert(m_count == 1);
     if (m_is_free_signal) {
         // We are not going to get anymore credits for this vc
         // So send a credit in any case
@@ -85,6 +104,7 @@ Credit::print(std::ostream& out) const
     out << "Type=" << m_type << " ";
     out << "VC=" << m_vc << " ";
     out << "FreeVC=" << m_is_free_signal << " ";
+    out << "Count=" << m_count << " ";
     out << "Set Time=" << m_time << " ";
     out << "]";
 }
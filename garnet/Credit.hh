@@ -37,6 +37,7 @@
 #include "base/types.hh"
 #include "mem/ruby/network/garnet/CommonTypes.hh"
 #include "mem/ruby/network/garnet/flit.hh"
+#include "mem/ruby/network/garnet/flitBuffer.hh"
 
 namespace gem5
 {
@@ -48,14 +49,15 @@ namespace garnet
 {
 
 // Credit Signal for buffers inside VC
-// Carries m_vc (inherits from flit.hh)
-// and m_is_free_signal (whether VC is free or not)
+// Carries m_vc (inherits from flit.hh),
+// m_is_free_signal (whether VC is free or not)
+// and m_count (buffers freed, several credits of a VC may be coalesced)
 
 class Credit : public flit
 {
   public:
     Credit() {};
-    Credit(int vc, bool is_free_signal, Tick curTime);
+    Credit(int vc, bool is_free_signal, Tick curTime, int count = 1);
 
     // Functions used by SerDes
     flit* serialize(int ser_id, int parts, uint32_t bWidth);
@@ -64,10 +66,44 @@ class Credit : public flit
 
     ~Credit() {};
 
+    // Credits are allocated from their own free list
+    static void *
+    operator new(std::size_t size)
+    {
+        assert(size == sizeof(Credit));
+        return flitPool<sizeof(Credit)>::allocate();
+    }
+
+    static void
+    operator delete(void *ptr, std::size_t size)
+    {
+        assert(size == sizeof(Credit));
+        flitPool<sizeof(Credit)>::release(ptr);
+    }
+
     bool is_free_signal() { return m_is_free_signal; }
+    int get_count() { return m_count; }
+
+    // Adds a credit of vc to this one if it is for the same VC and
+    // not freeing it yet (the next packet's credits follow the free)
+    inline bool
+    coalesce(int vc, bool is_free_signal)
+    {
+        if (vc != m_vc || m_is_free_signal)
+            return false;
+        m_count++;
+        m_is_free_signal = is_free_signal;
+        return true;
+    }
+
+    // Queues a credit in credit_queue, coalesced with the last queued
+    // credit if allowed
+    static void send(flitBuffer *credit_queue, int vc, bool is_free_signal,
+                     Tick curTime, bool allow_coalesce);
 
   private:
     bool m_is_free_signal;
+    int m_count;
 };
 
 } // namespace garnet
@@ -47,7 +47,15 @@ class CreditLink : public NetworkLink
 {
   public:
     typedef CreditLinkParams Params;
-    CreditLink(const Params &p) : NetworkLink(p) {}
+    CreditLink(const Params &p) : NetworkLink(p), m_coalesce(true) {}
+
+    // Credits of a VC waiting in the same credit queue may travel as one
+    // (not through SerDes, which converts credits one by one)
+    bool coalesceCredits() const { return m_coalesce; }
+    void setCoalesceCredits(bool coalesce) { m_coalesce = coalesce; }
+
+  private:
+    bool m_coalesce;
 };
 
 } // namespace garnet
@@ -46,7 +46,7 @@ namespace garnet
 
 CrossbarSwitch::CrossbarSwitch(Router *router)
   : Consumer(router), m_router(router), m_num_vcs(m_router->get_num_vcs()),
-    m_crossbar_activity(0), switchBuffers(0)
+    m_crossbar_activity(0), switchBuffers(0), m_num_flits(0)
 {
 }
 
@@ -83,34 +83,10 @@ CrossbarSwitch::wakeup()
             t_flit->set_time(m_router->clockEdge(Cycles(1)));
 
             // This will take care of waking up the Network Link
-            // in the next cycle
-            if(m_router->getOutportDirection(outport)==std::string("Wireless_Out"+std::to_string(t_flit->get_dest_wireless())))
-            {
-                Cycles c = Cycles(1);
-                Tick clk_edge=m_router->clockEdge(c);
-                for(int i=0;i<m_router->m_Wireless_unit.size();i++)
-                {
-                    std::cout<<"Inserting flit at wireless router "<<m_router->m_Wireless_unit[i]->get_direction()<<"\n";
-                    
-                    if(m_router->m_Wireless_unit[i]->get_outlink_id() == m_router->getOutputUnit(outport)->get_outlink_id())
-                    {
-                        m_router->m_Wireless_unit[i]->insert_flit_wireless(t_flit,clk_edge);
-                    }
-                    else{
-                        flit* new_t_fli= new flit(*t_flit);
-                        m_router->m_Wireless_unit[i]->insert_flit_wireless(new_t_fli,clk_edge);
-                    }
-
-                    
-
-                }
-            }
-            else{
-                std::cout<<"Inserting flit at Non wireless router "<<m_router->getOutputUnit(outport)->get_direction()<<"\n";
-
+            // (or the WirelessChannel) in the next cycle
             m_router->getOutputUnit(outport)->insert_flit(t_flit);
-            }
             switch_buffer.getTopFlit();
+            m_num_flits--;
             m_crossbar_activity++;
         }
     }
@@ -87,6 +87,15 @@ GarnetIntLink::init()
         dstNetBridge->initBridge(dstCredBridge, dstCdcEn, dstSerdesEn);
         dstCredBridge->initBridge(dstNetBridge, dstCdcEn, dstSerdesEn);
     }
+
+    // SerDes converts credits one by one
+    if (srcSerdesEn || dstSerdesEn) {
+        m_credit_link->setCoalesceCredits(false);
+        if (srcBridgeEn)
+            srcCredBridge->setCoalesceCredits(false);
+        if (dstBridgeEn)
+            dstCredBridge->setCoalesceCredits(false);
+    }
 }
 
 void
@@ -155,6 +164,17 @@ GarnetExtLink::init()
         intNetBridge[1]->initBridge(intCredBridge[1], intCdcEn, intSerdesEn);
         intCredBridge[1]->initBridge(intNetBridge[1], intCdcEn, intSerdesEn);
     }
+
+    // SerDes converts credits one by one
+    if (extSerdesEn || intSerdesEn) {
+        for (int i = 0; i < 2; i++) {
+            m_credit_links[i]->setCoalesceCredits(false);
+            if (extBridgeEn)
+                extCredBridge[i]->setCoalesceCredits(false);
+            if (intBridgeEn)
+                intCredBridge[i]->setCoalesceCredits(false);
+        }
+    }
 }
 
 void
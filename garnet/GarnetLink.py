@@ -73,6 +73,36 @@ class NetworkBridge(CreditLink):
     cdc_latency = Param.Cycles(1, "Latency of CDC Unit")
 
 
+# Shared wireless medium among hybrid routers. Each hybrid router gets
+# one "Wireless_Out_ch<channel_id>" port into the channel and one
+# "Wireless_In_ch<channel_id>" port fed by its own receive link, or
+# with rx_port_per_source one "Wireless_In<src>_ch<channel_id>" port
+# per other hybrid router <src>. Every channel has its own token.
+class WirelessChannel(ClockedObject):
+    type = "WirelessChannel"
+    cxx_header = "mem/ruby/network/garnet/WirelessChannel.hh"
+    cxx_class = "gem5::ruby::garnet::WirelessChannel"
+
+    channel_id = Param.Int(0, "wireless channel id")
+    hybrid_routers = VectorParam.GarnetRouter(
+        [], "hybrid routers with a transceiver on this channel"
+    )
+    rx_port_per_source = Param.Bool(
+        False, "one receive port per transmitter at each hybrid router"
+    )
+    rx_links = VectorParam.NetworkLink(
+        [],
+        "receive link into each hybrid router (per source: ordered by "
+        "receiver, then by transmitter, skipping the receiver itself)",
+    )
+    rx_credit_links = VectorParam.CreditLink(
+        [], "credit link from each receive port back to the channel"
+    )
+    latency = Param.Cycles(1, "wireless link latency")
+    supported_vnets = VectorParam.Int([], "Vnets supported")
+    width = Param.UInt32(Parent.ni_flit_size, "bit-width of the channel")
+
+
 # Interior fixed pipeline links between routers
 class GarnetIntLink(BasicIntLink):
     type = "GarnetIntLink"
@@ -32,9 +32,12 @@
 #include "mem/ruby/network/garnet/GarnetNetwork.hh"
 
 #include <cassert>
+#include <cstdlib>
+#include <limits>
 
 #include "base/cast.hh"
 #include "base/compiler.hh"
+#include "debug/GarnetWireless.hh"
 #include "debug/RubyNetwork.hh"
 #include "mem/ruby/common/NetDest.hh"
 #include "mem/ruby/network/MessageBuffer.hh"
@@ -44,6 +47,7 @@
 #include "mem/ruby/network/garnet/NetworkInterface.hh"
 #include "mem/ruby/network/garnet/NetworkLink.hh"
 #include "mem/ruby/network/garnet/Router.hh"
+#include "mem/ruby/network/garnet/WirelessChannel.hh"
 #include "mem/ruby/system/RubySystem.hh"
 
 namespace gem5
@@ -63,32 +67,62 @@ namespace garnet
 
 GarnetNetwork::GarnetNetwork(const Params &p)
     : Network(p),
-    tokenChangeEvent([this]{token_change();},"tokenchange",true,Event::Debug_Enable_Pri)
+    m_wireless_token(this, name() + ".wirelessToken")
 {
     m_num_rows = p.num_rows;
+    m_mesh = false;
     m_ni_flit_size = p.ni_flit_size;
     m_max_vcs_per_vnet = 0;
     m_buffers_per_data_vc = p.buffers_per_data_vc;
     m_buffers_per_ctrl_vc = p.buffers_per_ctrl_vc;
     m_routing_algorithm = p.routing_algorithm;
+    m_hybrid_route_table = p.hybrid_route_table;
+    m_token_mode = p.wireless_token_mode;
+    m_token_hold = p.wireless_token_hold;
+    m_token_hold_flits = p.wireless_token_hold_flits;
+    m_arbitration = p.arbitration;
+    m_qos_starvation_cycles = p.qos_starvation_cycles;
+    m_wireless_multicast = p.wireless_multicast;
+    m_escape_vc = p.escape_vc;
+    m_lookahead_routing = p.lookahead_routing;
+    m_wireless_bypass = p.wireless_bypass;
+    m_path_stats = p.path_stats;
     m_next_packet_id = 0;
+    m_flits_in_flight = 0;
     m_hybrid_routers = p.hybrid_routers;
-    std::cout<<"Creating hybrid routers   ";
-    for(int i=0;i<m_hybrid_routers.size();i++){
-        std::cout<<m_hybrid_routers[i]<<" ";
-    }
-    std::cout<<"\n";
     for (const auto& node : m_hybrid_routers) {
+        DPRINTF(GarnetWireless, "Router %d is a hybrid router\n", node);
         std::vector<int> connections = m_hybrid_routers;
         connections.erase(std::remove(connections.begin(), connections.end(), node), connections.end());
         hybrid_connections[node] = connections;
     }
-    
+
+    if (!p.traffic_trace.empty()) {
+        m_traffic_trace = std::make_unique<TrafficTrace>(this,
+            p.traffic_trace, p.traffic_trace_prefetch);
+    }
+
+    if (!p.binary_trace.empty()) {
+        m_trace = std::make_unique<GarnetTrace>(p.binary_trace,
+                                                p.binary_trace_buffer);
+    }
+
+    if (!p.telemetry_file.empty()) {
+        m_telemetry = std::make_unique<GarnetTelemetry>(this,
+            p.telemetry_file, p.telemetry_interval, p.telemetry_routers,
+            p.telemetry_buffer_samples, p.telemetry_csv);
+    }
 
     m_enable_fault_model = p.enable_fault_model;
     if (m_enable_fault_model)
         fault_model = p.fault_model;
 
+    m_wireless_channels = p.wireless_channels;
+    fatal_if(!m_wireless_channels.empty() &&
+             m_wireless_channels.size() != p.num_wireless_channels,
+             "%s: %d wireless channels configured, expected %d\n", name(),
+             m_wireless_channels.size(), p.num_wireless_channels);
+
     m_vnet_type.resize(m_virtual_networks);
 
     for (int i = 0 ; i < m_virtual_networks ; i++) {
@@ -109,6 +143,9 @@ GarnetNetwork::GarnetNetwork(const Params &p)
         router->init_net_ptr(this);
     }
 
+    // Token of the point-to-point wireless links, if any
+    m_wireless_token.init(m_hybrid_routers, this);
+
     // record the network interfaces
     for (std::vector<ClockedObject*>::const_iterator i = p.netifs.begin();
          i != p.netifs.end(); ++i) {
@@ -124,7 +161,6 @@ GarnetNetwork::GarnetNetwork(const Params &p)
 void
 GarnetNetwork::init()
 {
-    schedule(tokenChangeEvent,100);
     Network::init();
 
     for (int i=0; i < m_nodes; i++) {
@@ -136,6 +172,16 @@ GarnetNetwork::init()
     assert(m_topology_ptr != NULL);
     m_topology_ptr->createLinks(this);
 
+    // The wireless ports are added after the wired ones, so the
+    // routing table indices of the wired ports are unchanged
+    if (!m_wireless_channels.empty()) {
+        // Hybrid routers are only connected through shared channels
+        hybrid_connections.clear();
+        for (auto *channel : m_wireless_channels) {
+            makeWirelessLinks(channel);
+        }
+    }
+
     // Initialize topology specific parameters
     if (getNumRows() > 0) {
         // Only for Mesh topology
@@ -149,6 +195,64 @@ GarnetNetwork::init()
         m_num_cols = -1;
     }
 
+    // The XY coordinates of the hybrid routing only hold if every
+    // wired link joins mesh neighbours (not in a torus, for example).
+    // Otherwise the hybrid routing follows the hop matrix.
+    m_mesh = (m_num_cols > 0);
+    for (const auto &[src, dest, type] : m_wired_links) {
+        if (!m_mesh)
+            break;
+        bool same_row = (src / m_num_cols == dest / m_num_cols);
+        if (!((type == EAST_PORT_ && dest == src + 1 && same_row) ||
+              (type == WEST_PORT_ && dest == src - 1 && same_row) ||
+              (type == NORTH_PORT_ && dest == src + m_num_cols) ||
+              (type == SOUTH_PORT_ && dest == src - m_num_cols))) {
+            m_mesh = false;
+            break;
+        }
+    }
+    computeHops();
+
+    // Escape VCs route strict XY, the adaptive VCs keep the rest
+    if (m_escape_vc) {
+        fatal_if(!m_mesh, "Escape VCs need a mesh topology\n");
+        fatal_if(m_wireless_multicast,
+                 "Escape VCs are not supported with wireless multicast\n");
+        for (auto *router : m_routers) {
+            fatal_if(router->get_vc_per_vnet() < 2,
+                     "Escape VCs need at least 2 VCs per vnet on "
+                     "router %d\n", router->get_id());
+        }
+    }
+
+    // Multicast packets are received by the hybrid router nearest
+    // (in wired hops) to each destination router
+    if (m_wireless_multicast) {
+        fatal_if(m_wireless_channels.empty() ||
+                 (m_routing_algorithm != CUSTOM_ &&
+                  m_routing_algorithm != ADAPTIVE_),
+                 "Wireless multicast needs wireless channels "
+                 "with custom or adaptive routing\n");
+        for (auto *channel : m_wireless_channels) {
+            fatal_if(channel->getNumTransceivers() !=
+                     m_hybrid_routers.size(),
+                     "Wireless multicast needs every hybrid router on "
+                     "%s\n", channel->name());
+        }
+
+        m_serving_hybrid.assign(m_routers.size(), -1);
+        for (int router = 0; router < m_routers.size(); router++) {
+            int best_hops = std::numeric_limits<int>::max();
+            for (int hybrid : m_hybrid_routers) {
+                int hops = getHops(hybrid, router);
+                if (hops < best_hops) {
+                    best_hops = hops;
+                    m_serving_hybrid[router] = hybrid;
+                }
+            }
+        }
+    }
+
     // FaultModel: declare each router to the fault model
     if (isFaultModelEnabled()) {
         for (std::vector<Router*>::const_iterator i= m_routers.begin();
@@ -158,8 +262,8 @@ GarnetNetwork::init()
                 fault_model->declare_router(router->get_num_inports(),
                                             router->get_num_outports(),
                                             router->get_vc_per_vnet(),
-                                            getBuffersPerDataVC(),
-                                            getBuffersPerCtrlVC());
+                                            router->getBuffersPerDataVC(),
+                                            router->getBuffersPerCtrlVC());
             assert(router_id == router->get_id());
             router->printAggregateFaultProbability(std::cout);
             router->printFaultVector(std::cout);
@@ -167,6 +271,113 @@ GarnetNetwork::init()
     }
 }
 
+void
+GarnetNetwork::startup()
+{
+    Network::startup();
+
+    // The tokens are scheduled from the (restored) current tick. The
+    // tokens of the channels are started by the channels.
+    if (m_wireless_channels.empty())
+        m_wireless_token.startup();
+    if (m_traffic_trace)
+        m_traffic_trace->start();
+    if (m_telemetry)
+        m_telemetry->start();
+}
+
+/*
+ * In-flight flits and their VC and credit state are not checkpointed:
+ * the flits carry protocol messages, which are not serializable. The
+ * network drains instead (the traffic trace stops injecting), and a
+ * drained network only keeps its token and arbitration state.
+ */
+DrainState
+GarnetNetwork::drain()
+{
+    if (m_traffic_trace)
+        m_traffic_trace->pause();
+
+    if (isDrained())
+        return DrainState::Drained;
+
+    DPRINTF(RubyNetwork, "Draining %d flits\n", m_flits_in_flight);
+    return DrainState::Draining;
+}
+
+bool
+GarnetNetwork::isDrained() const
+{
+    if (m_flits_in_flight > 0)
+        return false;
+    for (auto *ni : m_nis) {
+        if (ni->hasTraceMessages())
+            return false;
+    }
+    return true;
+}
+
+void
+GarnetNetwork::drainResume()
+{
+    if (m_traffic_trace)
+        m_traffic_trace->start();
+}
+
+void
+GarnetNetwork::serialize(CheckpointOut &cp) const
+{
+    assert(m_flits_in_flight == 0);
+    SERIALIZE_SCALAR(m_next_packet_id);
+    m_wireless_token.serializeSection(cp, "wireless_token");
+    if (m_traffic_trace)
+        m_traffic_trace->serializeSection(cp, "traffic_trace");
+}
+
+void
+GarnetNetwork::unserialize(CheckpointIn &cp)
+{
+    UNSERIALIZE_SCALAR(m_next_packet_id);
+    m_wireless_token.unserializeSection(cp, "wireless_token");
+    if (m_traffic_trace)
+        m_traffic_trace->unserializeSection(cp, "traffic_trace");
+}
+
+void
+GarnetNetwork::injectTraceRecord(const TrafficTraceRecord &rec)
+{
+    fatal_if(rec.src >= m_nis.size() || rec.dest >= m_nis.size(),
+             "%s: traffic trace message from NI %d to NI %d, the network "
+             "has %d NIs\n", name(), rec.src, rec.dest, m_nis.size());
+    fatal_if(rec.vnet >= m_virtual_networks,
+             "%s: traffic trace message on vnet %d, the network has %d "
+             "vnets\n", name(), rec.vnet, m_virtual_networks);
+
+    MessageSizeType size = (rec.size <= m_control_msg_size) ?
+        MessageSizeType_Control : MessageSizeType_Data;
+    m_nis[rec.src]->enqueueTraceMessage(rec.dest, rec.vnet, size, rec.tick);
+}
+
+/*
+ * Estimated wait for the token of the wireless medium of router_id,
+ * on its most favorable channel.
+ */
+int
+GarnetNetwork::expectedTokenWait(int router_id)
+{
+    if (m_wireless_channels.empty())
+        return m_wireless_token.expectedWait(router_id);
+
+    int wait = std::numeric_limits<int>::max();
+    for (auto *channel : m_wireless_channels) {
+        if (channel->getTransceiverIdx(router_id) != -1) {
+            wait = std::min(wait,
+                            channel->getToken()->expectedWait(router_id));
+        }
+    }
+    return (wait == std::numeric_limits<int>::max()) ? 0 : wait;
+}
+
 /*
  * This function creates a link from the Network Interface (NI)
  * into the Network.
@@ -174,13 +385,6 @@ GarnetNetwork::init()
  * the Router to the NI
 */
 void
-GarnetNetwork::token_change()
-{
-        token_id=(token_id+1)%4;
-        std::cout<<"token is "<<m_hybrid_routers[token_id]<<" at time "<<curTick()<<"\n";
-        schedule(tokenChangeEvent,nextCycle());
-}
-void
 GarnetNetwork::makeExtInLink(NodeID global_src, SwitchID dest, BasicLink* link,
                              std::vector<NetDest>& routing_table_entry)
 {
@@ -344,6 +548,10 @@ GarnetNetwork::makeInternalLink(SwitchID src, SwitchID dest, BasicLink* link,
                              std::max(m_routers[dest]->get_vc_per_vnet(),
                              m_routers[src]->get_vc_per_vnet()));
 
+    PortType src_outport_type = Router::portDirectionToType(src_outport_dirn);
+    if (src_outport_type != WIRELESS_OUT_PORT_)
+        m_wired_links.emplace_back(src, dest, src_outport_type);
+
     /*
      * We check if a bridge was enabled at any end of the link.
      * The bridge is enabled if either of clock domain
@@ -357,15 +565,17 @@ GarnetNetwork::makeInternalLink(SwitchID src, SwitchID dest, BasicLink* link,
      * bridge is enabled, we would connect:
      * Router--->NetworkBridge--->GarnetIntLink---->Router
      */
+    int dst_inport = m_routers[dest]->get_num_inports();
     if (garnet_link->dstBridgeEn) {
         DPRINTF(RubyNetwork, "Enable destination bridge for %s\n",
             garnet_link->name());
         NetworkBridge *n_bridge = garnet_link->dstNetBridge;
         m_routers[dest]->addInPort(dst_inport_dirn, n_bridge,
-                                   garnet_link->dstCredBridge);
+                                   garnet_link->dstCredBridge, src);
         m_networkbridges.push_back(n_bridge);
     } else {
-        m_routers[dest]->addInPort(dst_inport_dirn, net_link, credit_link);
+        m_routers[dest]->addInPort(dst_inport_dirn, net_link, credit_link,
+                                   src);
     }
 
     if (garnet_link->srcBridgeEn) {
@@ -376,13 +586,119 @@ GarnetNetwork::makeInternalLink(SwitchID src, SwitchID dest, BasicLink* link,
             addOutPort(src_outport_dirn, n_bridge,
                        routing_table_entry,
                        link->m_weight, garnet_link->srcCredBridge,
-                       m_routers[dest]->get_vc_per_vnet());
+                       m_routers[dest]->get_vc_per_vnet(), dest,
+                       Router::portDirectionToType(dst_inport_dirn));
         m_networkbridges.push_back(n_bridge);
     } else {
         m_routers[src]->addOutPort(src_outport_dirn, net_link,
                         routing_table_entry,
                         link->m_weight, credit_link,
-                        m_routers[dest]->get_vc_per_vnet());
+                        m_routers[dest]->get_vc_per_vnet(), dest,
+                        Router::portDirectionToType(dst_inport_dirn));
+    }
+
+    // With lookahead routing, src computes the route of its head flits
+    // at dst_inport
+    if (m_lookahead_routing) {
+        m_routers[src]->getOutputUnit(m_routers[src]->get_num_outports() - 1)
+            ->set_peer_inport(dst_inport);
+        m_routers[dest]->getInputUnit(dst_inport)->set_lookahead(true);
+    }
+}
+
+/*
+ * Breadth-first search from every router over the wired links. The
+ * hybrid routing compares wired and wireless paths with these hop
+ * counts, whatever the topology (mesh, torus, concentrated mesh,
+ * chiplets joined only by wireless, ...).
+ */
+void
+GarnetNetwork::computeHops()
+{
+    int num_routers = m_routers.size();
+    std::vector<std::vector<int>> neighbours(num_routers);
+    for (const auto &[src, dest, type] : m_wired_links)
+        neighbours[src].push_back(dest);
+
+    m_hops.assign(num_routers * num_routers, UNREACHABLE_HOPS);
+    std::vector<int> queue(num_routers);
+    for (int src = 0; src < num_routers; src++) {
+        int *hops = &m_hops[src * num_routers];
+        int head = 0, tail = 0;
+        hops[src] = 0;
+        queue[tail++] = src;
+        while (head < tail) {
+            int router = queue[head++];
+            for (int next : neighbours[router]) {
+                if (hops[next] == UNREACHABLE_HOPS) {
+                    hops[next] = hops[router] + 1;
+                    queue[tail++] = next;
+                }
+            }
+        }
+    }
+}
+
+/*
+ * This function attaches every hybrid router of a WirelessChannel to it.
+ * Each router gets a "Wireless_Out_ch<id>" port whose flits go onto the
+ * shared medium, and a "Wireless_In_ch<id>" port fed by the channel's
+ * receive link for that router (or one "Wireless_In<src>_ch<id>" port
+ * per transmitting router <src>). Credits from the receive ports
+ * return to the channel.
+ * Hybrid routers sharing the channel are connected for custom routing.
+*/
+
+void
+GarnetNetwork::makeWirelessLinks(WirelessChannel *channel)
+{
+    channel->init_net_ptr(this);
+
+    for (int i = 0; i < channel->getNumTransceivers(); i++) {
+        Router *router = channel->getRouter(i);
+        fatal_if(std::find(m_hybrid_routers.begin(), m_hybrid_routers.end(),
+                           router->get_id()) == m_hybrid_routers.end(),
+                 "Router %d on %s is not a hybrid router\n",
+                 router->get_id(), channel->name());
+
+        m_max_vcs_per_vnet = std::max(m_max_vcs_per_vnet,
+                                      router->get_vc_per_vnet());
+
+        // No destinations are reachable through the wireless port
+        // with table-based routing
+        std::vector<NetDest> routing_table_entry(m_virtual_networks);
+        router->addWirelessOutPort(channel, routing_table_entry);
+
+        std::vector<int> &connections = hybrid_connections[router->get_id()];
+        for (int j = 0; j < channel->getNumTransceivers(); j++) {
+            int peer = channel->getRouter(j)->get_id();
+            if (j != i && std::find(connections.begin(), connections.end(),
+                                    peer) == connections.end()) {
+                connections.push_back(peer);
+            }
+        }
+    }
+
+    // Receive ports: "Wireless_In_ch<id>", or "Wireless_In<src>_ch<id>"
+    // if the channel has one per transmitter
+    for (int port = 0; port < channel->getNumRxPorts(); port++) {
+        Router *router = channel->getRouter(channel->getRxPortReceiver(port));
+        int src = channel->getRxPortSource(port);
+
+        NetworkLink *rx_link = channel->getRxLink(port);
+        rx_link->setType(WIRELESS_);
+        CreditLink *credit_link = channel->getRxCreditLink(port);
+
+        m_networklinks.push_back(rx_link);
+        m_creditlinks.push_back(credit_link);
+
+        std::string src_name = (src == -1) ? "" :
+            std::to_string(channel->getRouter(src)->get_id());
+        router->addInPort("Wireless_In" + src_name + "_ch" +
+                          std::to_string(channel->get_id()),
+                          rx_link, credit_link,
+                          (src == -1) ? -1 :
+                          channel->getRouter(src)->get_id());
     }
 }
 
@@ -533,6 +849,89 @@ GarnetNetwork::regStats()
     m_avg_hops.name(name() + ".average_hops");
     m_avg_hops = m_total_hops / sum(m_flits_received);
 
+    // Wireless
+    for (int i = 0; i < m_virtual_networks; i++) {
+        std::string vnet = csprintf(".vnet-%i", i);
+        statistics::Histogram *token_wait = new statistics::Histogram();
+        token_wait->init(16)
+            .name(name() + ".token_wait_cycles" + vnet)
+            .desc("cycles a wireless packet waits for the token")
+            .flags(statistics::nozero | statistics::pdf);
+        m_token_wait_cycles.push_back(token_wait);
+
+        statistics::Histogram *wired = new statistics::Histogram();
+        wired->init(16)
+            .name(name() + ".wired_packet_latency" + vnet)
+            .desc("network latency (cycles) of the wired packets")
+            .flags(statistics::nozero | statistics::pdf);
+        m_wired_packet_latency.push_back(wired);
+
+        statistics::Histogram *wireless = new statistics::Histogram();
+        wireless->init(16)
+            .name(name() + ".wireless_packet_latency" + vnet)
+            .desc("network latency (cycles) of the packets with a "
+                  "wireless hop")
+            .flags(statistics::nozero | statistics::pdf);
+        m_wireless_packet_latency.push_back(wireless);
+    }
+
+    m_wireless_packets
+        .init(m_virtual_networks)
+        .name(name() + ".wireless_packets")
+        .flags(statistics::total | statistics::nozero | statistics::oneline)
+        ;
+    for (int i = 0; i < m_virtual_networks; i++) {
+        m_wireless_packets.subname(i, csprintf("vnet-%i", i));
+    }
+
+    m_wireless_packet_fraction
+        .name(name() + ".wireless_packet_fraction")
+        .flags(statistics::oneline);
+    m_wireless_packet_fraction = m_wireless_packets / m_packets_received;
+
+    m_wireless_bypass_flits
+        .init(m_virtual_networks)
+        .name(name() + ".wireless_bypass_flits")
+        .desc("flits sent on from a wireless receive port in their "
+              "arrival cycle (express bypass)")
+        .flags(statistics::total | statistics::nozero | statistics::oneline)
+        ;
+    for (int i = 0; i < m_virtual_networks; i++) {
+        m_wireless_bypass_flits.subname(i, csprintf("vnet-%i", i));
+    }
+
+    // Paths
+    if (m_path_stats) {
+        m_path_length
+            .init(16)
+            .name(name() + ".path_length")
+            .desc("routers traversed by the received packets")
+            .flags(statistics::nozero | statistics::pdf);
+
+        m_router_transits
+            .init(m_routers.size())
+            .name(name() + ".router_transits")
+            .desc("received packets that traversed each router")
+            .flags(statistics::nozero)
+            ;
+        for (int i = 0; i < m_routers.size(); i++) {
+            m_router_transits.subname(i, csprintf("router-%i", i));
+        }
+
+        m_hybrid_index.assign(m_routers.size(), -1);
+        m_hybrid_transits
+            .init(m_hybrid_routers.size())
+            .name(name() + ".hybrid_transits")
+            .desc("received packets that traversed each hybrid router")
+            .flags(statistics::nozero)
+            ;
+        for (int i = 0; i < m_hybrid_routers.size(); i++) {
+            m_hybrid_index[m_hybrid_routers[i]] = i;
+            m_hybrid_transits.subname(i,
+                csprintf("router-%i", m_hybrid_routers[i]));
+        }
+    }
+
     // Links
     m_total_ext_in_link_utilization
         .name(name() + ".ext_in_link_utilization");
@@ -540,6 +939,9 @@ GarnetNetwork::regStats()
         .name(name() + ".ext_out_link_utilization");
     m_total_int_link_utilization
         .name(name() + ".int_link_utilization");
+    m_total_wireless_link_utilization
+        .name(name() + ".wireless_link_utilization")
+        .flags(statistics::nozero);
     m_average_link_utilization
         .name(name() + ".avg_link_utilization");
     m_average_vc_load
@@ -587,6 +989,8 @@ GarnetNetwork::collateStats()
             m_total_ext_out_link_utilization += activity;
         else if (type == INT_)
             m_total_int_link_utilization += activity;
+        else if (type == WIRELESS_)
+            m_total_wireless_link_utilization += activity;
 
         m_average_link_utilization +=
             (double(activity) / time_delta);
@@ -601,6 +1005,10 @@ GarnetNetwork::collateStats()
     for (int i = 0; i < m_routers.size(); i++) {
         m_routers[i]->collateStats();
     }
+
+    for (auto *channel : m_wireless_channels) {
+        channel->collateStats(time_delta);
+    }
 }
 
 void
@@ -623,6 +1031,18 @@ GarnetNetwork::print(std::ostream& out) const
     out << "[GarnetNetwork]";
 }
 
+void
+GarnetNetwork::record_path(const PacketPath &path)
+{
+    m_path_length.sample(path.length);
+    for (int i = 0; i < path.recorded(); i++) {
+        int router_id = path.routers[i];
+        m_router_transits[router_id]++;
+        if (m_hybrid_index[router_id] != -1)
+            m_hybrid_transits[m_hybrid_index[router_id]]++;
+    }
+}
+
 void
 GarnetNetwork::update_traffic_distribution(RouteInfo route)
 {
@@ -660,6 +1080,11 @@ GarnetNetwork::functionalRead(Packet *pkt, WriteMask &mask)
             read = true;
     }
 
+    for (auto *channel : m_wireless_channels) {
+        if (channel->functionalRead(pkt, mask))
+            read = true;
+    }
+
     return read;
 }
 
@@ -680,6 +1105,10 @@ GarnetNetwork::functionalWrite(Packet *pkt)
         num_functional_writes += m_networklinks[i]->functionalWrite(pkt);
     }
 
+    for (auto *channel : m_wireless_channels) {
+        num_functional_writes += channel->functionalWrite(pkt);
+    }
+
     return num_functional_writes;
 }
 
@@ -33,11 +33,19 @@
 #define __MEM_RUBY_NETWORK_GARNET_0_GARNETNETWORK_HH__
 
 #include <iostream>
+#include <memory>
+#include <tuple>
 #include <vector>
 
 #include "mem/ruby/network/Network.hh"
 #include "mem/ruby/network/fault_model/FaultModel.hh"
+#include "base/trace.hh"
 #include "mem/ruby/network/garnet/CommonTypes.hh"
+#include "mem/ruby/network/garnet/GarnetTelemetry.hh"
+#include "mem/ruby/network/garnet/GarnetTrace.hh"
+#include "mem/ruby/network/garnet/TrafficTrace.hh"
+#include "mem/ruby/network/garnet/WirelessToken.hh"
+#include "enums/SwitchArbitration.hh"
 #include "params/GarnetNetwork.hh"
 
 namespace gem5
@@ -57,6 +65,8 @@ class Router;
 class NetworkLink;
 class NetworkBridge;
 class CreditLink;
+class WirelessChannel;
+struct PacketPath;
 
 class GarnetNetwork : public Network
 {
@@ -66,6 +76,15 @@ class GarnetNetwork : public Network
     ~GarnetNetwork() = default;
 
     void init();
+    void startup();
+
+    // Checkpoints are taken once no flits are left in the network
+    DrainState drain();
+    void drainResume();
+    // No flits, nor traffic trace messages waiting for a VC
+    bool isDrained() const;
+    void serialize(CheckpointOut &cp) const;
+    void unserialize(CheckpointIn &cp);
 
     const char *garnetVersion = "3.0";
 
@@ -74,12 +93,27 @@ class GarnetNetwork : public Network
     // for 2D topology
     int getNumRows() const { return m_num_rows; }
     int getNumCols() { return m_num_cols; }
+    // True if the wired links form a row-major mesh (XY coordinates)
+    bool isMesh() const { return m_mesh; }
+
+    // Wired (router to router, without wireless) hop count from src
+    // to dest, UNREACHABLE_HOPS if there is no wired path
+    static constexpr int UNREACHABLE_HOPS = 1 << 20;
+    int
+    getHops(int src, int dest) const
+    {
+        return m_hops[src * m_routers.size() + dest];
+    }
 
     // for network
     uint32_t getNiFlitSize() const { return m_ni_flit_size; }
     uint32_t getBuffersPerDataVC() { return m_buffers_per_data_vc; }
     uint32_t getBuffersPerCtrlVC() { return m_buffers_per_ctrl_vc; }
     int getRoutingAlgorithm() const { return m_routing_algorithm; }
+    bool isHybridRouteTableEnabled() const { return m_hybrid_route_table; }
+    bool isPathStatsEnabled() const { return m_path_stats; }
+    bool isWirelessBypassEnabled() const { return m_wireless_bypass; }
+    bool isTrafficTraceEnabled() const { return (bool) m_traffic_trace; }
 
     bool isFaultModelEnabled() const { return m_enable_fault_model; }
     FaultModel* fault_model;
@@ -93,6 +127,7 @@ class GarnetNetwork : public Network
         return m_vnet_type[vnet];
     }
     int getNumRouters();
+    Router *getRouter(int router_id) { return m_routers[router_id]; }
     int get_router_id(int ni, int vnet);
 
 
@@ -106,6 +141,40 @@ class GarnetNetwork : public Network
                           PortDirection src_outport_dirn,
                           PortDirection dest_inport_dirn);
 
+    // Attach the hybrid routers to a shared wireless channel
+    void makeWirelessLinks(WirelessChannel *channel);
+    int getNumWirelessChannels() { return m_wireless_channels.size(); }
+    WirelessChannel *
+    getWirelessChannel(int idx)
+    {
+        return m_wireless_channels[idx];
+    }
+
+    // Token of the point-to-point wireless links
+    WirelessToken *getWirelessToken() { return &m_wireless_token; }
+    enums::WirelessTokenMode getTokenMode() { return m_token_mode; }
+    enums::WirelessTokenHold getTokenHold() { return m_token_hold; }
+    uint32_t getTokenHoldFlits() { return m_token_hold_flits; }
+    enums::SwitchArbitration getArbitration() { return m_arbitration; }
+    uint32_t getQosStarvationCycles() { return m_qos_starvation_cycles; }
+    int expectedTokenWait(int router_id);
+
+    // Wireless multicast of single-flit messages
+    bool isWirelessMulticast() const { return m_wireless_multicast; }
+    // Hybrid router receiving the multicast packets for router_id
+    int getServingHybrid(int router_id) { return m_serving_hybrid[router_id]; }
+
+    // Number of escape VCs at the start of each vnet (0 or 1)
+    int getEscapeVcs() const { return m_escape_vc ? 1 : 0; }
+
+    // Binary flit trace (compiled out without tracing support)
+    inline void
+    traceFlit(GarnetTraceEvent event, flit *t_flit, int router, int port)
+    {
+        if (TRACING_ON && m_trace)
+            m_trace->record(event, t_flit, router, port, curTick());
+    }
+
     bool functionalRead(Packet *pkt, WriteMask &mask);
     //! Function for performing a functional write. The return value
     //! indicates the number of messages that were written.
@@ -133,8 +202,22 @@ class GarnetNetwork : public Network
         m_packet_queueing_latency[vnet] += latency;
     }
 
-    void increment_injected_flits(int vnet) { m_flits_injected[vnet]++; }
-    void increment_received_flits(int vnet) { m_flits_received[vnet]++; }
+    void
+    increment_injected_flits(int vnet)
+    {
+        m_flits_injected[vnet]++;
+        m_flits_in_flight++;
+    }
+
+    void
+    increment_received_flits(int vnet)
+    {
+        m_flits_received[vnet]++;
+        if (--m_flits_in_flight == 0 &&
+            drainState() == DrainState::Draining && isDrained()) {
+            signalDrainDone();
+        }
+    }
 
     void
     increment_flit_network_latency(Tick latency, int vnet)
@@ -154,12 +237,38 @@ class GarnetNetwork : public Network
         m_total_hops += hops;
     }
 
+    // Wireless statistics
+    void
+    sample_token_wait(int vnet, Cycles wait)
+    {
+        m_token_wait_cycles[vnet]->sample(wait);
+    }
+
+    void
+    increment_wireless_bypass(int vnet)
+    {
+        m_wireless_bypass_flits[vnet]++;
+    }
+
+    void
+    sample_packet_latency(int vnet, Cycles latency, bool wireless)
+    {
+        if (wireless) {
+            m_wireless_packets[vnet]++;
+            m_wireless_packet_latency[vnet]->sample(latency);
+        } else {
+            m_wired_packet_latency[vnet]->sample(latency);
+        }
+    }
+
+    // Hands a traffic trace message to its source NI
+    void injectTraceRecord(const TrafficTraceRecord &rec);
+
+    // Path statistics of a packet received by an NI
+    void record_path(const PacketPath &path);
+
     void update_traffic_distribution(RouteInfo route);
     int getNextPacketID() { return m_next_packet_id++; }
-    void token_change();
-    int get_token_id() {return m_hybrid_routers[token_id];}
-    int token_id=0;
-    EventFunctionWrapper tokenChangeEvent;
     std::vector<int> m_hybrid_routers;
     std::unordered_map<int,std::vector<int>>hybrid_connections;
 
@@ -167,14 +276,36 @@ class GarnetNetwork : public Network
     // Configuration
     int m_num_rows;
     int m_num_cols;
+    bool m_mesh;
+    // Wired router to router links {src, dest, src outport type}
+    std::vector<std::tuple<int, int, PortType>> m_wired_links;
+    // All-pairs wired hop counts, indexed by src * routers + dest
+    std::vector<int> m_hops;
+    // Fills m_hops (breadth-first search over m_wired_links)
+    void computeHops();
     uint32_t m_ni_flit_size;
     uint32_t m_max_vcs_per_vnet;
     uint32_t m_buffers_per_ctrl_vc;
     uint32_t m_buffers_per_data_vc;
     int m_routing_algorithm;
-    
+    bool m_hybrid_route_table;
+    enums::WirelessTokenMode m_token_mode;
+    enums::WirelessTokenHold m_token_hold;
+    uint32_t m_token_hold_flits;
+    enums::SwitchArbitration m_arbitration;
+    uint32_t m_qos_starvation_cycles;
+    WirelessToken m_wireless_token;
+    bool m_wireless_multicast;
+    std::vector<int> m_serving_hybrid;
+    bool m_escape_vc;
+    bool m_lookahead_routing;
+    bool m_path_stats;
+    bool m_wireless_bypass;
+    std::unique_ptr<GarnetTrace> m_trace;
+    std::unique_ptr<TrafficTrace> m_traffic_trace;
+    std::unique_ptr<GarnetTelemetry> m_telemetry;
+
     bool m_enable_fault_model;
-    std::vector<int> a ={18,21,45,50};
 
     // Statistical variables
     statistics::Vector m_packets_received;
@@ -202,12 +333,31 @@ class GarnetNetwork : public Network
     statistics::Scalar m_total_ext_in_link_utilization;
     statistics::Scalar m_total_ext_out_link_utilization;
     statistics::Scalar m_total_int_link_utilization;
+    statistics::Scalar m_total_wireless_link_utilization;
     statistics::Scalar m_average_link_utilization;
     statistics::Vector m_average_vc_load;
 
     statistics::Scalar  m_total_hops;
     statistics::Formula m_avg_hops;
 
+    // Per vnet: token wait of the wireless packets at the transmitting
+    // hybrid router, network latency of the wired and wireless packets
+    std::vector<statistics::Histogram *> m_token_wait_cycles;
+    std::vector<statistics::Histogram *> m_wired_packet_latency;
+    std::vector<statistics::Histogram *> m_wireless_packet_latency;
+    statistics::Vector m_wireless_packets;
+    statistics::Formula m_wireless_packet_fraction;
+    // Flits taking the wireless express bypass
+    statistics::Vector m_wireless_bypass_flits;
+
+    // Path statistics (path_stats): routers traversed per packet,
+    // packets through each router and through each hybrid router
+    statistics::Histogram m_path_length;
+    statistics::Vector m_router_transits;
+    statistics::Vector m_hybrid_transits;
+    // Index of each router in m_hybrid_transits (-1: not hybrid)
+    std::vector<int> m_hybrid_index;
+
     std::vector<std::vector<statistics::Scalar *>> m_data_traffic_distribution;
     std::vector<std::vector<statistics::Scalar *>> m_ctrl_traffic_distribution;
 
@@ -221,7 +371,11 @@ class GarnetNetwork : public Network
     std::vector<NetworkBridge *> m_networkbridges; // All network bridges
     std::vector<CreditLink *> m_creditlinks; // All credit links in the network
     std::vector<NetworkInterface *> m_nis;   // All NI's in Network
+    std::vector<WirelessChannel *> m_wireless_channels; // Wireless media
     int m_next_packet_id; // static vairable for packet id allocation
+    // Flits between their injection and ejection NIs (not reset with
+    // the stats)
+    uint64_t m_flits_in_flight;
 };
 
 inline std::ostream&
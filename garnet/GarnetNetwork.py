@@ -35,6 +35,33 @@ from m5.objects.BasicRouter import BasicRouter
 from m5.objects.ClockedObject import ClockedObject
 
 
+# TOKEN_ROTATE: the token moves to the next hybrid router every cycle.
+# TOKEN_DEMAND: the token is only handed to hybrid routers with a
+# pending wireless request, and is not moved while nobody requests it.
+class WirelessTokenMode(Enum):
+    vals = ["TOKEN_ROTATE", "TOKEN_DEMAND"]
+
+
+# How long a hybrid router keeps the token once it starts transmitting.
+# The token is always released early once the holder has no more flits
+# for its wireless outport.
+# HOLD_NONE:  one cycle slot, the token may move after every flit.
+# HOLD_TAIL:  until the tail flit of the current packet is sent.
+# HOLD_FLITS: until the tail, or at most wireless_token_hold_flits flits.
+# HOLD_QUEUE: across packets, for at most wireless_token_hold_flits flits.
+class WirelessTokenHold(Enum):
+    vals = ["HOLD_NONE", "HOLD_TAIL", "HOLD_FLITS", "HOLD_QUEUE"]
+
+
+# Arbitration of the switch allocator stages and of the demand token.
+# ARB_ROUND_ROBIN: round robin among the requesters.
+# ARB_QOS: packets waiting for qos_starvation_cycles first, then
+# control packets (single-flit or on a control vnet), then the oldest;
+# round robin among equals.
+class SwitchArbitration(Enum):
+    vals = ["ARB_ROUND_ROBIN", "ARB_QOS"]
+
+
 class GarnetNetwork(RubyNetwork):
     type = "GarnetNetwork"
     cxx_header = "mem/ruby/network/garnet/GarnetNetwork.hh"
@@ -45,13 +72,90 @@ class GarnetNetwork(RubyNetwork):
     vcs_per_vnet = Param.UInt32(4, "virtual channels per virtual network")
     buffers_per_data_vc = Param.UInt32(4, "buffers per data virtual channel")
     buffers_per_ctrl_vc = Param.UInt32(1, "buffers per ctrl virtual channel")
-    routing_algorithm = Param.Int(0, "0: Weight-based Table, 1: XY, 2: Custom")
+    routing_algorithm = Param.Int(
+        0, "0: Weight-based Table, 1: XY, 2: Custom, 3: Adaptive hybrid"
+    )
     enable_fault_model = Param.Bool(False, "enable network fault model")
     fault_model = Param.FaultModel(NULL, "network fault model")
     garnet_deadlock_threshold = Param.UInt32(
         50000, "network-level deadlock threshold"
     )
     hybrid_routers=VectorParam.Int([],"List of Hybrid routers")
+    num_wireless_channels = Param.UInt32(
+        1, "number of independent wireless channels"
+    )
+    wireless_channels = VectorParam.WirelessChannel(
+        [], "shared wireless media among the hybrid routers"
+    )
+    wireless_token_mode = Param.WirelessTokenMode(
+        "TOKEN_ROTATE", "arbitration of the wireless token"
+    )
+    wireless_token_hold = Param.WirelessTokenHold(
+        "HOLD_NONE", "how long the wireless token is held"
+    )
+    wireless_token_hold_flits = Param.UInt32(
+        8, "max flits per token tenure (HOLD_FLITS and HOLD_QUEUE)"
+    )
+    arbitration = Param.SwitchArbitration(
+        "ARB_ROUND_ROBIN", "switch allocation and demand token arbitration"
+    )
+    qos_starvation_cycles = Param.UInt32(
+        64, "cycles after which a packet is served first (ARB_QOS)"
+    )
+    hybrid_route_table = Param.Bool(
+        False, "precompute per-router hybrid routes at init (custom routing)"
+    )
+    wireless_multicast = Param.Bool(
+        False, "send single-flit multicast messages as one packet "
+        "broadcast on the wireless channel (custom/adaptive routing)"
+    )
+    lookahead_routing = Param.Bool(
+        False, "compute the outport of the next router one hop early, "
+        "saving a router pipeline stage on wired router-to-router hops"
+    )
+    escape_vc = Param.Bool(
+        False, "reserve the first VC of each vnet as an XY escape VC "
+        "for deadlock freedom of adaptive routing (mesh only)"
+    )
+    wireless_bypass = Param.Bool(
+        False, "flits arriving on a wireless receive port skip buffering "
+        "and SA when their wired outport and outvc are free"
+    )
+    path_stats = Param.Bool(
+        False, "record the routers traversed by each packet and report "
+        "path length and per-router transit statistics"
+    )
+    traffic_trace = Param.String(
+        "", "binary file of (tick, src, dest, vnet, size) records injected "
+        "by the network interfaces instead of protocol traffic "
+        "(empty: disabled)"
+    )
+    traffic_trace_prefetch = Param.UInt32(
+        65536, "traffic trace records read ahead of the current one"
+    )
+    binary_trace = Param.String(
+        "", "file in the output directory for the binary flit trace "
+        "(empty: disabled)"
+    )
+    binary_trace_buffer = Param.UInt32(
+        65536, "flit trace records buffered before each write"
+    )
+    telemetry_file = Param.String(
+        "", "file in the output directory for the periodic router "
+        "occupancy and wireless telemetry (empty: disabled)"
+    )
+    telemetry_interval = Param.UInt32(
+        1000, "cycles between two telemetry samples"
+    )
+    telemetry_routers = VectorParam.Int(
+        [], "routers sampled by the telemetry (empty: all)"
+    )
+    telemetry_buffer_samples = Param.UInt32(
+        1024, "telemetry samples buffered before each write"
+    )
+    telemetry_csv = Param.Bool(
+        False, "write the telemetry as CSV instead of binary"
+    )
 
 
 class GarnetNetworkInterface(ClockedObject):
@@ -78,6 +182,20 @@ class GarnetRouter(BasicRouter):
     vcs_per_vnet = Param.UInt32(
         Parent.vcs_per_vnet, "virtual channels per virtual network"
     )
+    buffers_per_data_vc = Param.UInt32(
+        Parent.buffers_per_data_vc, "buffers per data virtual channel"
+    )
+    buffers_per_ctrl_vc = Param.UInt32(
+        Parent.buffers_per_ctrl_vc, "buffers per ctrl virtual channel"
+    )
+    wireless_buffers_per_data_vc = Param.UInt32(
+        0, "buffers per data virtual channel of the wireless receive "
+        "ports (0: buffers_per_data_vc)"
+    )
+    wireless_buffers_per_ctrl_vc = Param.UInt32(
+        0, "buffers per ctrl virtual channel of the wireless receive "
+        "ports (0: buffers_per_ctrl_vc)"
+    )
     virt_nets = Param.UInt32(
         Parent.number_of_virtual_networks, "number of virtual networks"
     )
@@ -0,0 +1,196 @@
+/*
+ * Copyright (c) 2024 The gem5_garnet_wireless authors
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+#include "mem/ruby/network/garnet/GarnetTelemetry.hh"
+
+#include <numeric>
+
+#include "base/logging.hh"
+#include "base/output.hh"
+#include "mem/ruby/network/garnet/GarnetNetwork.hh"
+#include "mem/ruby/network/garnet/InputUnit.hh"
+#include "mem/ruby/network/garnet/OutputUnit.hh"
+#include "mem/ruby/network/garnet/Router.hh"
+#include "mem/ruby/network/garnet/WirelessChannel.hh"
+#include "sim/cur_tick.hh"
+#include "sim/sim_exit.hh"
+
+namespace gem5
+{
+
+namespace ruby
+{
+
+namespace garnet
+{
+
+GarnetTelemetry::GarnetTelemetry(GarnetNetwork *net_ptr,
+                                 const std::string &filename,
+                                 uint32_t interval,
+                                 const std::vector<int> &routers,
+                                 uint32_t buffer_samples, bool csv)
+    : m_net_ptr(net_ptr), m_interval(interval), m_router_ids(routers),
+      m_csv(csv), m_buffer_samples(buffer_samples), m_rows(0),
+      m_event([this]{ sample(); }, "GarnetTelemetry")
+{
+    fatal_if(interval == 0, "Garnet telemetry needs a non-zero interval");
+    fatal_if(buffer_samples == 0,
+             "Garnet telemetry needs a non-empty buffer");
+    m_out = simout.create(filename, !csv);
+    fatal_if(!m_out, "Cannot open garnet telemetry file %s\n", filename);
+
+    registerExitCallback([this]() { flush(); });
+}
+
+void
+GarnetTelemetry::start()
+{
+    if (m_router_ids.empty()) {
+        m_router_ids.resize(m_net_ptr->getNumRouters());
+        std::iota(m_router_ids.begin(), m_router_ids.end(), 0);
+    }
+
+    m_names.push_back("tick");
+    for (int id : m_router_ids) {
+        fatal_if(id < 0 || id >= m_net_ptr->getNumRouters(),
+                 "Garnet telemetry: no router %d\n", id);
+        Router *router = m_net_ptr->getRouter(id);
+        m_routers.push_back(router);
+
+        std::string prefix = "r" + std::to_string(id) + ".";
+        m_names.push_back(prefix + "flits");
+        m_names.push_back(prefix + "active_vcs");
+        m_names.push_back(prefix + "wireless_queue");
+        for (int p = 0; p < router->get_num_outports(); p++)
+            m_names.push_back(prefix + "out" + std::to_string(p) +
+                              ".credits");
+    }
+    if (m_net_ptr->getNumWirelessChannels() == 0) {
+        m_names.push_back("token_holder");
+    } else {
+        for (int c = 0; c < m_net_ptr->getNumWirelessChannels(); c++)
+            m_names.push_back("ch" + std::to_string(c) + ".token_holder");
+    }
+
+    m_columns.resize(m_names.size());
+    for (auto &column : m_columns)
+        column.resize(m_buffer_samples);
+    writeHeader();
+
+    m_net_ptr->schedule(m_event, m_net_ptr->clockEdge(m_interval));
+}
+
+void
+GarnetTelemetry::writeHeader()
+{
+    std::ostream *os = m_out->stream();
+    if (m_csv) {
+        for (size_t col = 0; col < m_names.size(); col++)
+            *os << (col ? "," : "") << m_names[col];
+        *os << "\n";
+        return;
+    }
+
+    uint32_t num_columns = m_names.size();
+    os->write("GTLM", 4);
+    os->write(reinterpret_cast<const char *>(&num_columns),
+              sizeof(num_columns));
+    for (const auto &name : m_names)
+        os->write(name.c_str(), name.size() + 1);
+}
+
+void
+GarnetTelemetry::sample()
+{
+    size_t col = 0;
+    m_columns[col++][m_rows] = curTick();
+    for (Router *router : m_routers) {
+        int64_t flits = 0;
+        int64_t active_vcs = 0;
+        for (int p = 0; p < router->get_num_inports(); p++) {
+            InputUnit *input_unit = router->getInputUnit(p);
+            flits += input_unit->get_buffered_flits();
+            active_vcs += input_unit->get_active_vcs();
+        }
+        m_columns[col++][m_rows] = flits;
+        m_columns[col++][m_rows] = active_vcs;
+        m_columns[col++][m_rows] = router->get_wireless_queue_depth();
+        for (int p = 0; p < router->get_num_outports(); p++) {
+            m_columns[col++][m_rows] =
+                router->getOutputUnit(p)->get_free_credits();
+        }
+    }
+    if (m_net_ptr->getNumWirelessChannels() == 0) {
+        WirelessToken *token = m_net_ptr->getWirelessToken();
+        m_columns[col++][m_rows] =
+            token->getNumHolders() ? token->get_holder() : -1;
+    } else {
+        for (int c = 0; c < m_net_ptr->getNumWirelessChannels(); c++) {
+            WirelessToken *token =
+                m_net_ptr->getWirelessChannel(c)->getToken();
+            m_columns[col++][m_rows] =
+                token->getNumHolders() ? token->get_holder() : -1;
+        }
+    }
+    assert(col == m_columns.size());
+
+    if (++m_rows == m_buffer_samples)
+        flush();
+
+    m_net_ptr->schedule(m_event, m_net_ptr->clockEdge(m_interval));
+}
+
+void
+GarnetTelemetry::flush()
+{
+    if (m_rows == 0)
+        return;
+
+    std::ostream *os = m_out->stream();
+    if (m_csv) {
+        for (size_t row = 0; row < m_rows; row++) {
+            for (size_t col = 0; col < m_columns.size(); col++)
+                *os << (col ? "," : "") << m_columns[col][row];
+            *os << "\n";
+        }
+    } else {
+        uint32_t rows = m_rows;
+        os->write(reinterpret_cast<const char *>(&rows), sizeof(rows));
+        for (const auto &column : m_columns) {
+            os->write(reinterpret_cast<const char *>(column.data()),
+                      m_rows * sizeof(int64_t));
+        }
+    }
+    os->flush();
+    m_rows = 0;
+}
+
+} // namespace garnet
+} // namespace ruby
+} // namespace gem5
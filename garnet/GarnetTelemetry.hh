@@ -0,0 +1,102 @@
+/*
+ * Copyright (c) 2024 The gem5_garnet_wireless authors
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+#ifndef __MEM_RUBY_NETWORK_GARNET_0_GARNETTELEMETRY_HH__
+#define __MEM_RUBY_NETWORK_GARNET_0_GARNETTELEMETRY_HH__
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "base/types.hh"
+#include "sim/eventq.hh"
+
+namespace gem5
+{
+
+class OutputStream;
+
+namespace ruby
+{
+
+namespace garnet
+{
+
+class GarnetNetwork;
+class Router;
+
+/*
+ * Periodic telemetry: every interval cycles one event samples, for each
+ * monitored router, the flits buffered and the active VCs over its
+ * inports, the free credits of each outport and its wireless queue
+ * depth, plus the holder of every wireless token. The samples go into
+ * preallocated columns (one per value) that are written out in chunks
+ * of buffer_samples rows, and at simulation exit.
+ *
+ * CSV output has a header row of column names. The binary output has
+ * a "GTLM" header (uint32 column count, NUL-terminated column names)
+ * followed by chunks: a uint32 row count, then each column's rows as
+ * int64 values.
+ */
+class GarnetTelemetry
+{
+  public:
+    GarnetTelemetry(GarnetNetwork *net_ptr, const std::string &filename,
+                    uint32_t interval, const std::vector<int> &routers,
+                    uint32_t buffer_samples, bool csv);
+
+    // Defines the columns (once the ports exist) and schedules the
+    // first sample
+    void start();
+    void flush();
+
+  private:
+    void sample();
+    void writeHeader();
+
+    GarnetNetwork *m_net_ptr;
+    OutputStream *m_out;
+    Cycles m_interval;
+    std::vector<int> m_router_ids;
+    std::vector<Router *> m_routers;
+    bool m_csv;
+
+    std::vector<std::string> m_names;
+    std::vector<std::vector<int64_t>> m_columns;
+    size_t m_buffer_samples;
+    size_t m_rows;
+
+    EventFunctionWrapper m_event;
+};
+
+} // namespace garnet
+} // namespace ruby
+} // namespace gem5
+
+#endif // __MEM_RUBY_NETWORK_GARNET_0_GARNETTELEMETRY_HH__
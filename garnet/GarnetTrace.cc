@@ -0,0 +1,84 @@
+/*
+ * Copyright (c) 2024 The gem5_garnet_wireless authors
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+#include "mem/ruby/network/garnet/GarnetTrace.hh"
+
+#include "base/logging.hh"
+#include "base/output.hh"
+#include "mem/ruby/network/garnet/flit.hh"
+#include "sim/sim_exit.hh"
+
+namespace gem5
+{
+
+namespace ruby
+{
+
+namespace garnet
+{
+
+GarnetTrace::GarnetTrace(const std::string &filename,
+                         uint32_t buffer_records)
+    : m_buffer(buffer_records), m_count(0)
+{
+    fatal_if(buffer_records == 0, "Garnet trace needs a non-empty buffer");
+    m_out = simout.create(filename, true);
+    fatal_if(!m_out, "Cannot open garnet trace file %s\n", filename);
+
+    registerExitCallback([this]() { flush(); });
+}
+
+void
+GarnetTrace::fill(GarnetTraceRecord &rec, GarnetTraceEvent event,
+                  flit *t_flit, int router, int port, Tick time)
+{
+    rec.tick = time;
+    rec.packet_id = t_flit->getPacketID();
+    rec.router = router;
+    rec.port = port;
+    rec.flit_id = t_flit->get_id();
+    rec.event = event;
+    rec.vnet = t_flit->get_vnet();
+}
+
+void
+GarnetTrace::flush()
+{
+    if (m_count == 0)
+        return;
+
+    m_out->stream()->write(reinterpret_cast<const char *>(m_buffer.data()),
+                           m_count * sizeof(GarnetTraceRecord));
+    m_out->stream()->flush();
+    m_count = 0;
+}
+
+} // namespace garnet
+} // namespace ruby
+} // namespace gem5
@@ -0,0 +1,108 @@
+/*
+ * Copyright (c) 2024 The gem5_garnet_wireless authors
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+#ifndef __MEM_RUBY_NETWORK_GARNET_0_GARNETTRACE_HH__
+#define __MEM_RUBY_NETWORK_GARNET_0_GARNETTRACE_HH__
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "base/types.hh"
+
+namespace gem5
+{
+
+class OutputStream;
+
+namespace ruby
+{
+
+namespace garnet
+{
+
+class flit;
+
+enum GarnetTraceEvent : uint8_t
+{
+    TRACE_INJECT_,   // flit created by the NI
+    TRACE_ARRIVE_,   // flit buffered in a router input port
+    TRACE_SA_GRANT_, // flit won switch allocation for an outport
+    TRACE_EJECT_,    // flit consumed by the destination NI
+    NUM_TRACE_EVENT_
+};
+
+// One fixed-size record per flit event. For NI events router holds
+// the NI id and port is -1.
+struct GarnetTraceRecord
+{
+    uint64_t tick;
+    int32_t packet_id;
+    int16_t router;
+    int16_t port;
+    int16_t flit_id;
+    uint8_t event;
+    uint8_t vnet;
+};
+
+/*
+ * Binary flit trace: records are accumulated in memory and written
+ * to the output file in one large write whenever the buffer fills
+ * up, and at simulation exit.
+ */
+class GarnetTrace
+{
+  public:
+    GarnetTrace(const std::string &filename, uint32_t buffer_records);
+
+    inline void
+    record(GarnetTraceEvent event, flit *t_flit, int router, int port,
+           Tick time)
+    {
+        if (m_count == m_buffer.size())
+            flush();
+        fill(m_buffer[m_count++], event, t_flit, router, port, time);
+    }
+
+    void flush();
+
+  private:
+    void fill(GarnetTraceRecord &rec, GarnetTraceEvent event,
+              flit *t_flit, int router, int port, Tick time);
+
+    OutputStream *m_out;
+    std::vector<GarnetTraceRecord> m_buffer;
+    size_t m_count;
+};
+
+} // namespace garnet
+} // namespace ruby
+} // namespace gem5
+
+#endif // __MEM_RUBY_NETWORK_GARNET_0_GARNETTRACE_HH__
@@ -31,6 +31,9 @@
 
 #include "mem/ruby/network/garnet/InputUnit.hh"
 
+#include <tuple>
+
+#include "debug/GarnetWireless.hh"
 #include "debug/RubyNetwork.hh"
 #include "mem/ruby/network/garnet/Credit.hh"
 #include "mem/ruby/network/garnet/Router.hh"
@@ -46,9 +49,14 @@ namespace garnet
 
 InputUnit::InputUnit(int id, PortDirection direction, Router *router)
   : Consumer(router), m_router(router), m_id(id), m_direction(direction),
-    m_vc_per_vnet(m_router->get_vc_per_vnet())
+    m_port_type(UNKNOWN_PORT_), m_peer_router(-1), m_lookahead(false),
+    m_path_stats(m_router->get_net_ptr()->isPathStatsEnabled()),
+    m_wireless_bypass(m_router->get_net_ptr()->isWirelessBypassEnabled()),
+    m_vc_per_vnet(m_router->get_vc_per_vnet()), m_sa_vcs(0)
 {
     const int m_num_vcs = m_router->get_num_vcs();
+    fatal_if(m_num_vcs > 64, "Router %d: at most 64 VCs per port are "
+             "supported by the switch allocator\n", m_router->get_id());
     m_num_buffer_reads.resize(m_num_vcs/m_vc_per_vnet);
     m_num_buffer_writes.resize(m_num_vcs/m_vc_per_vnet);
     m_wireless_request.resize(m_num_vcs/m_vc_per_vnet);
@@ -61,9 +69,13 @@ InputUnit::InputUnit(int id, PortDirection direction, Router *router)
     }
 
     // Instantiating the virtual channels
+    // (the buffer of each VC is sized for the credits of its vnet)
+    PortType port_type = Router::portDirectionToType(direction);
     virtualChannels.reserve(m_num_vcs);
     for (int i=0; i < m_num_vcs; i++) {
-        virtualChannels.emplace_back();
+        int vnet = i / m_vc_per_vnet;
+        virtualChannels.emplace_back(
+            m_router->getBuffersPerVC(vnet, port_type));
     }
 }
 
@@ -84,18 +96,16 @@ InputUnit::wakeup()
     if (m_in_link->isReady(curTick())) {
 
         t_flit = m_in_link->consumeLink();
-        if(t_flit->get_dest_wireless() !=m_router->get_id() && m_direction == "Wireless_In")
-        {
-            std::cout<<"\n Dropping flit id "<<t_flit->get_id()<<" of the packet  "<<t_flit->getPacketID()<<" from the router "<<m_router->get_id()<<"\n";
-            //set_vc_idle(t_flit->get_vc(),curTick());
-            //increment_credit(t_flit->get_vc(), true, curTick());
-            delete t_flit;
-        }
-        else{
+
+        // The wireless channel only delivers flits to their receiver
+        assert(m_port_type != WIRELESS_IN_PORT_ ||
+               t_flit->get_dest_wireless() == m_router->get_id());
+
         DPRINTF(RubyNetwork, "Router[%d] Consuming:%s Width: %d Flit:%s\n",
         m_router->get_id(), m_in_link->name(),
         m_router->getBitWidth(), *t_flit);
-        std::cout<<"Flit of packet id  "<<t_flit->getPacketID()<<" arrived at "<<m_router->get_id()<<" in direction "<<m_direction<<"\n";
+        m_router->get_net_ptr()->traceFlit(TRACE_ARRIVE_, t_flit,
+            m_router->get_id(), m_id);
         assert(t_flit->m_width == m_router->getBitWidth());
         int vc = t_flit->get_vc();
         t_flit->increment_hops(); // for stats
@@ -107,16 +117,36 @@ InputUnit::wakeup()
             assert(virtualChannels[vc].get_state() == IDLE_);
             set_vc_active(vc, curTick());
 
+            // Packets in an escape VC stay on the XY escape path,
+            // the others route adaptively but keep the escape outport
+            // to fall back to in SA
+            bool use_escape = isEscapeVc(vc);
+            int escape_outport = -1;
+            if (m_router->get_net_ptr()->getEscapeVcs() > 0) {
+                escape_outport =
+                    m_router->escape_route_compute(t_flit->get_route());
+            }
+
             // Route computation for this vc
-            auto [outport,dest_hybrid_router] = m_router->route_compute(t_flit->get_route(),
-                m_id, m_direction);
+            // (the flit still carries the choice of the previous router)
+            int outport = escape_outport;
+            int dest_hybrid_router = -1;
+            if (m_lookahead) {
+                // Already done by the previous router
+                assert(t_flit->get_lookahead_outport() != -1);
+                outport = t_flit->get_lookahead_outport();
+                dest_hybrid_router = t_flit->get_lookahead_dest_wireless();
+            } else if (!use_escape) {
+                std::tie(outport, dest_hybrid_router) =
+                    m_router->route_compute(t_flit->get_route(), m_id,
+                        m_port_type, t_flit->get_dest_wireless());
+            }
             t_flit->set_dest_wireless(dest_hybrid_router);
 
-            std::cout<<"t_flit_id "<<t_flit->get_id()<<"Dest_hybrid_router "<<dest_hybrid_router<<"\n";
-            // if(m_router->getOutportDirection(outport)=="Wireless_Out")
-            // {
-            //     m_router->getOutputUnit(outport)
-            // }
+            DPRINTF(GarnetWireless, "Router[%d] packet %d routed to "
+                    "outport %d, dest hybrid router %d\n",
+                    m_router->get_id(), t_flit->getPacketID(), outport,
+                    dest_hybrid_router);
 
             // Update output port in VC
             // All flits in this packet will use this output port
@@ -124,37 +154,64 @@ InputUnit::wakeup()
             grant_wireless(vc,dest_hybrid_router);
 
             grant_outport(vc, outport);
+            grant_escape_outport(vc, escape_outport, use_escape);
+            if (m_router->getOutportType(outport) == WIRELESS_OUT_PORT_)
+                m_router->update_wireless_queue(1, outport);
 
         } else {
             assert(virtualChannels[vc].get_state() == ACTIVE_);
             t_flit->set_dest_wireless(virtualChannels[vc].get_outv_wireless());
-            std::cout<<"t_flit_id "<<t_flit->get_id()<<"Dest_hybrid_router "<<t_flit->get_dest_wireless()<<"\n";
         }
-        if ((t_flit->get_type() == TAIL_) || (t_flit->get_type() == HEAD_TAIL_)){
-                        t_flit->path.push_back(m_router->get_id());
-        
+
+        // The path is printed and aggregated by the destination NI
+        if ((m_path_stats || (TRACING_ON && debug::GarnetWireless)) &&
+            ((t_flit->get_type() == TAIL_) ||
+             (t_flit->get_type() == HEAD_TAIL_))) {
+            t_flit->get_path().record(m_router->get_id());
         }
 
 
+        // A flit arriving alone in its VC on a wireless receive port
+        // may bypass the buffer and SA
+        bool bypass = m_wireless_bypass && m_port_type == WIRELESS_IN_PORT_ &&
+            virtualChannels[vc].isEmpty();
+
         // Buffer the flit
         virtualChannels[vc].insertFlit(t_flit);
+        m_sa_vcs |= (uint64_t(1) << vc);
+        m_router->set_sa_inport(m_id);
 
         int vnet = vc/m_vc_per_vnet;
-        // number of writes same as reads
-        // any flit that is written will be read only once
-        m_num_buffer_writes[vnet]++;
-        m_num_buffer_reads[vnet]++;
-        std::string wireless="Wireless_Out";
-        if(m_router->getOutportDirection(virtualChannels[vc].get_outport()).find(wireless)!=std::string::npos)
+        if (m_router->getOutportType(virtualChannels[vc].get_outport()) ==
+            WIRELESS_OUT_PORT_)
         {
             m_wireless_request[vnet]++;
         }
-        if(m_direction=="Wireless_In")
+        if (m_port_type == WIRELESS_IN_PORT_)
         {
             m_wireless_transfer[vnet]++;
         }
 
+        // Straight to switch traversal in this cycle
+        if (bypass && m_router->try_bypass(m_id, vc)) {
+            DPRINTF(GarnetWireless, "Router[%d] flit of packet %d bypasses "
+                    "inport %d\n", m_router->get_id(), t_flit->getPacketID(),
+                    m_id);
+            m_router->get_net_ptr()->increment_wireless_bypass(vnet);
+            if (m_in_link->isReady(curTick()))
+                m_router->schedule_wakeup(Cycles(1));
+            return;
+        }
+
+        // number of writes same as reads
+        // any flit that is written will be read only once
+        m_num_buffer_writes[vnet]++;
+        m_num_buffer_reads[vnet]++;
+
+        // Lookahead routing takes route computation out of the pipeline
         Cycles pipe_stages = m_router->get_pipe_stages();
+        if (m_lookahead && pipe_stages > 1)
+            pipe_stages = pipe_stages - Cycles(1);
         if (pipe_stages == 1) {
             // 1-cycle router
             // Flit goes for SA directly
@@ -175,7 +232,6 @@ InputUnit::wakeup()
             m_router->schedule_wakeup(Cycles(1));
         }
     }
-    }
 }
 
 // Send a credit back to upstream router for this VC.
@@ -185,11 +241,31 @@ InputUnit::increment_credit(int in_vc, bool free_signal, Tick curTime)
 {
     DPRINTF(RubyNetwork, "Router[%d]: Sending a credit vc:%d free:%d to %s\n",
     m_router->get_id(), in_vc, free_signal, m_credit_link->name());
-    Credit *t_credit = new Credit(in_vc, free_signal, curTime);
-    creditQueue.insert(t_credit);
+    Credit::send(&creditQueue, in_vc, free_signal, curTime,
+                 m_credit_link->coalesceCredits());
     m_credit_link->scheduleEventAbsolute(m_router->clockEdge(Cycles(1)));
 }
 
+int
+InputUnit::get_buffered_flits() const
+{
+    int flits = 0;
+    for (const auto &vc : virtualChannels)
+        flits += vc.get_size();
+    return flits;
+}
+
+int
+InputUnit::get_active_vcs()
+{
+    int active = 0;
+    for (auto &vc : virtualChannels) {
+        if (vc.get_state() == ACTIVE_)
+            active++;
+    }
+    return active;
+}
+
 bool
 InputUnit::functionalRead(Packet *pkt, WriteMask &mask)
 {
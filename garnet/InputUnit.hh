@@ -62,6 +62,17 @@ class InputUnit : public Consumer
     void print(std::ostream& out) const {};
 
     inline PortDirection get_direction() { return m_direction; }
+    inline PortType get_port_type() { return m_port_type; }
+    inline int get_peer_router() { return m_peer_router; }
+    // The upstream router computes the outport of the head flits
+    inline void set_lookahead(bool lookahead) { m_lookahead = lookahead; }
+
+    inline void
+    set_port_info(PortType port_type, int peer_router)
+    {
+        m_port_type = port_type;
+        m_peer_router = peer_router;
+    }
 
     inline void
     set_vc_idle(int vc, Tick curTime)
@@ -92,6 +103,67 @@ class InputUnit : public Consumer
         virtualChannels[vc].set_outvc(outvc);
     }
 
+    inline void
+    grant_escape_outport(int vc, int outport, bool use_escape)
+    {
+        virtualChannels[vc].set_escape_outport(outport);
+        virtualChannels[vc].set_use_escape(use_escape);
+    }
+
+    // Moves the packet in vc from its adaptive route to the escape path
+    inline void
+    take_escape(int vc)
+    {
+        if (m_router->getOutportType(virtualChannels[vc].get_outport()) ==
+            WIRELESS_OUT_PORT_) {
+            m_router->update_wireless_queue(-1,
+                virtualChannels[vc].get_outport());
+        }
+        virtualChannels[vc].set_outport(
+            virtualChannels[vc].get_escape_outport());
+        virtualChannels[vc].set_out_wireless(-1);
+        virtualChannels[vc].set_use_escape(true);
+        virtualChannels[vc].peekTopFlit()->set_dest_wireless(-1);
+    }
+
+    inline int
+    get_escape_outport(int invc)
+    {
+        return virtualChannels[invc].get_escape_outport();
+    }
+
+    inline bool
+    get_use_escape(int invc)
+    {
+        return virtualChannels[invc].get_use_escape();
+    }
+
+    // Token wait of the packet in vc: starts when the router requests
+    // the token for it, stops when the router holds the token
+    inline void
+    wait_token(int vc)
+    {
+        if (virtualChannels[vc].get_token_wait_start() == MaxTick)
+            virtualChannels[vc].set_token_wait_start(curTick());
+    }
+
+    inline void
+    hold_token(int vc)
+    {
+        Tick start = virtualChannels[vc].get_token_wait_start();
+        if (start != MaxTick) {
+            virtualChannels[vc].set_token_wait(
+                virtualChannels[vc].get_token_wait() + curTick() - start);
+            virtualChannels[vc].set_token_wait_start(MaxTick);
+        }
+    }
+
+    inline Tick
+    get_token_wait(int invc)
+    {
+        return virtualChannels[invc].get_token_wait();
+    }
+
     inline int
     get_outport(int invc)
     {
@@ -109,6 +181,12 @@ class InputUnit : public Consumer
         return virtualChannels[invc].get_outv_wireless();
     }
 
+    inline VC_state_type
+    get_vc_state(int invc)
+    {
+        return virtualChannels[invc].get_state();
+    }
+
     inline Tick
     get_enqueue_time(int invc)
     {
@@ -117,6 +195,14 @@ class InputUnit : public Consumer
 
     void increment_credit(int in_vc, bool free_signal, Tick curTime);
 
+    // The first VCs of each vnet are escape VCs, if enabled
+    inline bool
+    isEscapeVc(int vc)
+    {
+        return vc % m_vc_per_vnet <
+            m_router->get_net_ptr()->getEscapeVcs();
+    }
+
     inline flit*
     peekTopFlit(int vc)
     {
@@ -126,9 +212,22 @@ class InputUnit : public Consumer
     inline flit*
     getTopFlit(int vc)
     {
-        return virtualChannels[vc].getTopFlit();
+        flit *t_flit = virtualChannels[vc].getTopFlit();
+        if (virtualChannels[vc].isEmpty()) {
+            m_sa_vcs &= ~(uint64_t(1) << vc);
+            if (m_sa_vcs == 0)
+                m_router->clear_sa_inport(m_id);
+        }
+        return t_flit;
     }
 
+    // Bitmask of the VCs holding flits (all of them wait for SA)
+    inline uint64_t get_sa_vcs() const { return m_sa_vcs; }
+
+    // Occupancy, sampled by the telemetry
+    int get_buffered_flits() const;
+    int get_active_vcs();
+
     inline bool
     need_stage(int vc, flit_stage stage, Tick time)
     {
@@ -175,6 +274,11 @@ class InputUnit : public Consumer
     Router *m_router;
     int m_id;
     PortDirection m_direction;
+    PortType m_port_type;
+    int m_peer_router;
+    bool m_lookahead;
+    bool m_path_stats;
+    bool m_wireless_bypass;
     int m_vc_per_vnet;
     NetworkLink *m_in_link;
     CreditLink *m_credit_link;
@@ -182,6 +286,7 @@ class InputUnit : public Consumer
 
     // Input Virtual channels
     std::vector<VirtualChannel> virtualChannels;
+    uint64_t m_sa_vcs;
 
     // Statistical variables
     std::vector<double> m_num_buffer_writes;
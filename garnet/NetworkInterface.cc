@@ -34,11 +34,15 @@
 
 #include <cassert>
 #include <cmath>
+#include <sstream>
 
+#include "base/bitfield.hh"
 #include "base/cast.hh"
+#include "debug/GarnetWireless.hh"
 #include "debug/RubyNetwork.hh"
 #include "mem/ruby/network/MessageBuffer.hh"
 #include "mem/ruby/network/garnet/Credit.hh"
+#include "mem/ruby/network/garnet/TrafficTrace.hh"
 #include "mem/ruby/network/garnet/flitBuffer.hh"
 #include "mem/ruby/slicc_interface/Message.hh"
 
@@ -55,10 +59,11 @@ NetworkInterface::NetworkInterface(const Params &p)
   : ClockedObject(p), Consumer(this), m_id(p.id),
     m_virtual_networks(p.virt_nets), m_vc_per_vnet(0),
     m_vc_allocator(m_virtual_networks, 0),
-    m_deadlock_threshold(p.garnet_deadlock_threshold),
+    m_deadlock_threshold(p.garnet_deadlock_threshold), m_idle_vcs(0),
     vc_busy_counter(m_virtual_networks, 0)
 {
     m_stall_count.resize(m_virtual_networks);
+    m_trace_msgs.resize(m_virtual_networks);
     niOutVcs.resize(0);
 }
 
@@ -96,13 +101,17 @@ NetworkInterface::addOutPort(NetworkLink *out_link,
     if (niOutVcs.size() == 0) {
         m_vc_per_vnet = consumerVcs;
         int m_num_vcs = consumerVcs * m_virtual_networks;
+        fatal_if(m_num_vcs > 64, "NI %d: at most 64 VCs are supported\n",
+                 m_id);
+        m_idle_vcs = mask(m_num_vcs);
         niOutVcs.resize(m_num_vcs);
         outVcState.reserve(m_num_vcs);
         m_ni_out_vcs_enqueue_time.resize(m_num_vcs);
         // instantiating the NI flit buffers
         for (int i = 0; i < m_num_vcs; i++) {
             m_ni_out_vcs_enqueue_time[i] = Tick(INFINITE_);
-            outVcState.emplace_back(i, m_net_ptr, consumerVcs);
+            outVcState.emplace_back(i, m_net_ptr, consumerVcs,
+                                    m_net_ptr->getRouter(router_id));
         }
 
         // Reset VC Per VNET for input links already instantiated
@@ -171,10 +180,12 @@ NetworkInterface::incrementStats(flit *t_flit)
         m_net_ptr->increment_received_packets(vnet);
         m_net_ptr->increment_packet_network_latency(network_delay, vnet);
         m_net_ptr->increment_packet_queueing_latency(queueing_delay, vnet);
+        m_net_ptr->sample_packet_latency(vnet,
+            ticksToCycles(network_delay), t_flit->crossed_wireless());
     }
 
     // Hops
-    m_net_ptr->increment_total_hops(t_flit->get_route().hops_traversed);
+    m_net_ptr->increment_total_hops(t_flit->get_hops());
 }
 
 /*
@@ -217,6 +228,17 @@ NetworkInterface::wakeup()
         }
     }
 
+    // Messages of the traffic trace, also one per cycle per vnet
+    if (m_net_ptr->isTrafficTraceEnabled()) {
+        for (int vnet = 0; vnet < m_trace_msgs.size(); ++vnet) {
+            std::deque<MsgPtr> &msgs = m_trace_msgs[vnet];
+            if (!msgs.empty() && flitisizeMessage(msgs.front(), vnet))
+                msgs.pop_front();
+            if (!msgs.empty())
+                scheduleEvent(Cycles(1));
+        }
+    }
+
     scheduleOutputLink();
 
     // Check if there are flits stalling a virtual channel. Track if a
@@ -231,6 +253,7 @@ NetworkInterface::wakeup()
             flit *t_flit = inNetLink->consumeLink();
             DPRINTF(RubyNetwork, "Recieved flit:%s\n", *t_flit);
             assert(t_flit->m_width == iPort->bitWidth());
+            m_net_ptr->traceFlit(TRACE_EJECT_, t_flit, m_id, -1);
 
             int vnet = t_flit->get_vnet();
             t_flit->set_dequeue_time(curTick());
@@ -240,26 +263,38 @@ NetworkInterface::wakeup()
             // credits.
             if (t_flit->get_type() == TAIL_ ||
                 t_flit->get_type() == HEAD_TAIL_) {
-                if (!iPort->messageEnqueuedThisCycle &&
-                    outNode_ptr[vnet]->areNSlotsAvailable(1, curTime)) {
+                // Traffic trace messages have no protocol consumer
+                bool trace_msg = m_net_ptr->isTrafficTraceEnabled() &&
+                    dynamic_cast<TraceMessage *>(t_flit->get_msg_ptr().get());
+                if (trace_msg || (!iPort->messageEnqueuedThisCycle &&
+                    outNode_ptr[vnet]->areNSlotsAvailable(1, curTime))) {
+
+                    if (m_net_ptr->isPathStatsEnabled())
+                        m_net_ptr->record_path(t_flit->get_path());
+
+                    if (TRACING_ON && debug::GarnetWireless) {
+                        const PacketPath &p = t_flit->get_path();
+                        std::ostringstream path;
+                        for (int i = 0; i < p.recorded(); i++)
+                            path << " " << p.routers[i];
+                        if (p.length > p.recorded())
+                            path << " ...";
+                        DPRINTF(GarnetWireless, "Packet [%d] path:%s "
+                                "enqueue time: %lld dequeue time: %lld\n",
+                                t_flit->getPacketID(), path.str(),
+                                t_flit->get_enqueue_time(),
+                                t_flit->get_dequeue_time());
+                    }
 
-                        //packet path print
-                        std::cout<<"\nPacket ["<<t_flit->getPacketID() <<"] path : ";
-                        for(int routerId: t_flit->path)
-                        std::cout<< routerId << " ";
-                        std::cout<<"\n Enqueue time : "<<t_flit->get_enqueue_time()<<" Dequeue time : "<<t_flit->get_dequeue_time()<<"\n";
-                        std::cout<<std::endl;
-
-                        
                     // Space is available. Enqueue to protocol buffer.
-                    outNode_ptr[vnet]->enqueue(t_flit->get_msg_ptr(), curTime,
-                                               cyclesToTicks(Cycles(1)));
+                    if (!trace_msg) {
+                        outNode_ptr[vnet]->enqueue(t_flit->get_msg_ptr(),
+                            curTime, cyclesToTicks(Cycles(1)));
+                    }
 
                     // Simply send a credit back since we are not buffering
                     // this flit in the NI
-                    Credit *cFlit = new Credit(t_flit->get_vc(),
-                                               true, curTick());
-                    iPort->sendCredit(cFlit);
+                    iPort->sendCredit(t_flit->get_vc(), true, curTick());
                     // Update stats and delete flit pointer
                     incrementStats(t_flit);
                     delete t_flit;
@@ -276,11 +311,9 @@ NetworkInterface::wakeup()
                 }
             } else {
                 // Non-tail flit. Send back a credit but not VC free signal.
-                Credit *cFlit = new Credit(t_flit->get_vc(), false,
-                                               curTick());
                 // Simply send a credit back since we are not buffering
                 // this flit in the NI
-                iPort->sendCredit(cFlit);
+                iPort->sendCredit(t_flit->get_vc(), false, curTick());
 
                 // Update stats and delete flit pointer.
                 incrementStats(t_flit);
@@ -293,13 +326,12 @@ NetworkInterface::wakeup()
 
     for (auto &oPort: outPorts) {
         CreditLink *inCreditLink = oPort->inCreditLink();
-        if (inCreditLink->isReady(curTick())) {
+        while (inCreditLink->isReady(curTick())) {
             Credit *t_credit = (Credit*) inCreditLink->consumeLink();
-            outVcState[t_credit->get_vc()].increment_credit();
-            if (t_credit->is_free_signal()) {
-                outVcState[t_credit->get_vc()].setState(IDLE_,
-                    curTick());
-            }
+            outVcState[t_credit->get_vc()].increment_credit(
+                t_credit->get_count());
+            if (t_credit->is_free_signal())
+                setVcState(t_credit->get_vc(), IDLE_);
             delete t_credit;
         }
     }
@@ -345,11 +377,11 @@ NetworkInterface::checkStallQueue()
 
                     // Send back a credit with free signal now that the
                     // VC is no longer stalled.
-                    Credit *cFlit = new Credit(stallFlit->get_vc(), true,
-                                                   curTick());
-                    iPort->sendCredit(cFlit);
+                    iPort->sendCredit(stallFlit->get_vc(), true, curTick());
 
                     // Update Stats
+                    if (m_net_ptr->isPathStatsEnabled())
+                        m_net_ptr->record_path(stallFlit->get_path());
                     incrementStats(stallFlit);
 
                     // Flit can now safely be deleted and removed from stall
@@ -373,6 +405,31 @@ NetworkInterface::checkStallQueue()
     }
 }
 
+// NetDest associated with the single destination destID
+static NetDest
+personalDest(NodeID destID)
+{
+    NetDest personal_dest;
+    for (int m = 0; m < (int) MachineType_NUM; m++) {
+        if ((destID >= MachineType_base_number((MachineType) m)) &&
+            destID < MachineType_base_number((MachineType) (m+1))) {
+            personal_dest.add((MachineID) {(MachineType) m, (destID -
+                MachineType_base_number((MachineType) m))});
+            break;
+        }
+    }
+    return personal_dest;
+}
+
+void
+NetworkInterface::enqueueTraceMessage(NodeID dest, int vnet,
+                                      MessageSizeType size, Tick time)
+{
+    m_trace_msgs[vnet].push_back(
+        std::make_shared<TraceMessage>(time, personalDest(dest), size));
+    scheduleEvent(Cycles(1));
+}
+
 // Embed the protocol message into flits
 bool
 NetworkInterface::flitisizeMessage(MsgPtr msg_ptr, int vnet)
@@ -394,6 +451,16 @@ NetworkInterface::flitisizeMessage(MsgPtr msg_ptr, int vnet)
         m_net_ptr->MessageSizeType_to_int(net_msg_ptr->getMessageSize()),
         vnet, oPort->bitWidth());
 
+    // Destinations served by other hybrid routers share one packet
+    // broadcast on the wireless channel. The rest are sent as unicast.
+    if (m_net_ptr->isWirelessMulticast() && num_flits == 1 &&
+        dest_nodes.size() > 1 && !m_net_ptr->isVNetOrdered(vnet)) {
+        if (!flitisizeWirelessMulticast(msg_ptr, vnet, oPort))
+            return false;
+        net_msg_dest = net_msg_ptr->getDestination();
+        dest_nodes = net_msg_dest.getAllDest();
+    }
+
     // loop to convert all multicast messages into unicast messages
     for (int ctr = 0; ctr < dest_nodes.size(); ctr++) {
 
@@ -408,18 +475,8 @@ NetworkInterface::flitisizeMessage(MsgPtr msg_ptr, int vnet)
 
         Message *new_net_msg_ptr = new_msg_ptr.get();
         if (dest_nodes.size() > 1) {
-            NetDest personal_dest;
-            for (int m = 0; m < (int) MachineType_NUM; m++) {
-                if ((destID >= MachineType_base_number((MachineType) m)) &&
-                    destID < MachineType_base_number((MachineType) (m+1))) {
-                    // calculating the NetDest associated with this destID
-                    personal_dest.clear();
-                    personal_dest.add((MachineID) {(MachineType) m, (destID -
-                        MachineType_base_number((MachineType) m))});
-                    new_net_msg_ptr->getDestination() = personal_dest;
-                    break;
-                }
-            }
+            NetDest personal_dest = personalDest(destID);
+            new_net_msg_ptr->getDestination() = personal_dest;
             net_msg_dest.removeNetDest(personal_dest);
             // removing the destination from the original message to reflect
             // that a message with this particular destination has been
@@ -446,39 +503,124 @@ NetworkInterface::flitisizeMessage(MsgPtr msg_ptr, int vnet)
         m_net_ptr->increment_injected_packets(vnet);
         m_net_ptr->update_traffic_distribution(route);
         int packet_id = m_net_ptr->getNextPacketID();
+        PacketInfoPtr packet =
+            std::make_shared<PacketInfo>(route, new_msg_ptr);
         for (int i = 0; i < num_flits; i++) {
             m_net_ptr->increment_injected_flits(vnet);
             flit *fl = new flit(packet_id,
-                i, vc, vnet, route, num_flits, new_msg_ptr,
+                i, vc, vnet, packet, num_flits,
                 m_net_ptr->MessageSizeType_to_int(
                 net_msg_ptr->getMessageSize()),
                 oPort->bitWidth(), curTick());
 
             fl->set_src_delay(curTick() - msg_ptr->getTime());
+            m_net_ptr->traceFlit(TRACE_INJECT_, fl, m_id, -1);
             niOutVcs[vc].insert(fl);
         }
 
         m_ni_out_vcs_enqueue_time[vc] = curTick();
-        outVcState[vc].setState(ACTIVE_, curTick());
+        setVcState(vc, ACTIVE_);
     }
     return true ;
 }
 
-// Looking for a free output vc
+/*
+ * Packs the destinations of a single-flit message that are served by a
+ * hybrid router other than the one of this NI into one packet. The
+ * packet is routed to the serving hybrid router of this NI, which
+ * broadcasts it once on a wireless channel; the channel hands one
+ * unicast copy per destination to the receiving hybrid routers.
+ *
+ * The packed destinations are removed from the message. Returns false
+ * if no VC is free (the message is then left untouched).
+ */
+bool
+NetworkInterface::flitisizeWirelessMulticast(MsgPtr msg_ptr, int vnet,
+                                             OutputPort *oPort)
+{
+    Message *net_msg_ptr = msg_ptr.get();
+    int src_hybrid = m_net_ptr->getServingHybrid(oPort->routerID());
+
+    std::vector<NodeID> multicast_nodes;
+    for (NodeID destID : net_msg_ptr->getDestination().getAllDest()) {
+        int dest_router = m_net_ptr->get_router_id(destID, vnet);
+        if (m_net_ptr->getServingHybrid(dest_router) != src_hybrid)
+            multicast_nodes.push_back(destID);
+    }
+
+    // A single remote destination is cheaper as a unicast packet
+    if (multicast_nodes.size() < 2)
+        return true;
+
+    int vc = calculateVC(vnet);
+    if (vc == -1)
+        return false;
+
+    RouteInfo route;
+    route.vnet = vnet;
+    route.src_ni = m_id;
+    route.src_router = oPort->routerID();
+    route.dest_ni = -1;
+    route.dest_router = src_hybrid;
+    route.hops_traversed = -1;
+
+    std::vector<WirelessFork> forks;
+    for (NodeID destID : multicast_nodes) {
+        NetDest personal_dest = personalDest(destID);
+        net_msg_ptr->getDestination().removeNetDest(personal_dest);
+        route.net_dest.addNetDest(personal_dest);
+
+        WirelessFork fork;
+        fork.msg_ptr = msg_ptr->clone();
+        fork.msg_ptr->getDestination() = personal_dest;
+        fork.route.vnet = vnet;
+        fork.route.net_dest = personal_dest;
+        fork.route.src_ni = m_id;
+        fork.route.src_router = oPort->routerID();
+        fork.route.dest_ni = destID;
+        fork.route.dest_router = m_net_ptr->get_router_id(destID, vnet);
+        fork.rx_router = m_net_ptr->getServingHybrid(fork.route.dest_router);
+        fork.vc = -1;
+        forks.push_back(fork);
+
+        // Every copy is accounted for as a packet, as in unicast mode
+        m_net_ptr->increment_injected_packets(vnet);
+        m_net_ptr->increment_injected_flits(vnet);
+        m_net_ptr->update_traffic_distribution(fork.route);
+    }
+
+    DPRINTF(GarnetWireless, "NI %d multicast to %d destinations through "
+            "hybrid router %d\n", m_id, forks.size(), src_hybrid);
+
+    PacketInfoPtr packet =
+        std::make_shared<PacketInfo>(route, forks.front().msg_ptr);
+    packet->wireless_forks = std::move(forks);
+    flit *fl = new flit(m_net_ptr->getNextPacketID(), 0, vc, vnet, packet,
+        1, m_net_ptr->MessageSizeType_to_int(net_msg_ptr->getMessageSize()),
+        oPort->bitWidth(), curTick());
+    fl->set_src_delay(curTick() - msg_ptr->getTime());
+    fl->set_dest_wireless(WIRELESS_MULTICAST_);
+    m_net_ptr->traceFlit(TRACE_INJECT_, fl, m_id, -1);
+    niOutVcs[vc].insert(fl);
+
+    m_ni_out_vcs_enqueue_time[vc] = curTick();
+    setVcState(vc, ACTIVE_);
+    return true;
+}
+
+// Looking for a free output vc: the first idle one of the vnet at or
+// after the round robin pointer, which then moves past it
 int
 NetworkInterface::calculateVC(int vnet)
 {
-    for (int i = 0; i < m_vc_per_vnet; i++) {
-        int delta = m_vc_allocator[vnet];
-        m_vc_allocator[vnet]++;
-        if (m_vc_allocator[vnet] == m_vc_per_vnet)
-            m_vc_allocator[vnet] = 0;
-
-        if (outVcState[(vnet*m_vc_per_vnet) + delta].isInState(
-                    IDLE_, curTick())) {
-            vc_busy_counter[vnet] = 0;
-            return ((vnet*m_vc_per_vnet) + delta);
-        }
+    int vc_base = vnet*m_vc_per_vnet;
+    uint64_t idle = (m_idle_vcs >> vc_base) & mask(m_vc_per_vnet);
+    if (idle != 0) {
+        uint64_t from_start = idle & (~uint64_t(0) << m_vc_allocator[vnet]);
+        int delta = findLsbSet(from_start != 0 ? from_start : idle);
+        m_vc_allocator[vnet] = (delta + 1) % m_vc_per_vnet;
+        vc_busy_counter[vnet] = 0;
+        return vc_base + delta;
     }
 
     vc_busy_counter[vnet] += 1;
@@ -677,6 +819,30 @@ NetworkInterface::print(std::ostream& out) const
     out << "[Network Interface]";
 }
 
+bool
+NetworkInterface::hasTraceMessages() const
+{
+    for (const auto &msgs : m_trace_msgs) {
+        if (!msgs.empty())
+            return true;
+    }
+    return false;
+}
+
+void
+NetworkInterface::serialize(CheckpointOut &cp) const
+{
+    SERIALIZE_CONTAINER(m_vc_allocator);
+}
+
+void
+NetworkInterface::unserialize(CheckpointIn &cp)
+{
+    UNSERIALIZE_CONTAINER(m_vc_allocator);
+    fatal_if(m_vc_allocator.size() != m_virtual_networks,
+             "NI %d: the checkpoint has other virtual networks\n", m_id);
+}
+
 bool
 NetworkInterface::functionalRead(Packet *pkt, WriteMask &mask)
 {
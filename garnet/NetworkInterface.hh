@@ -33,6 +33,7 @@
 #ifndef __MEM_RUBY_NETWORK_GARNET_0_NETWORKINTERFACE_HH__
 #define __MEM_RUBY_NETWORK_GARNET_0_NETWORKINTERFACE_HH__
 
+#include <deque>
 #include <iostream>
 #include <vector>
 
@@ -79,11 +80,20 @@ class NetworkInterface : public ClockedObject, public Consumer
     int get_vnet(int vc);
     void init_net_ptr(GarnetNetwork *net_ptr) { m_net_ptr = net_ptr; }
 
+    // VC round robin of a drained NI
+    void serialize(CheckpointOut &cp) const;
+    void unserialize(CheckpointIn &cp);
+
     bool functionalRead(Packet *pkt, WriteMask &mask);
     uint32_t functionalWrite(Packet *);
 
     void scheduleFlit(flit *t_flit);
 
+    // Message of the traffic trace, created at time
+    void enqueueTraceMessage(NodeID dest, int vnet, MessageSizeType size,
+                             Tick time);
+    bool hasTraceMessages() const;
+
     int get_router_id(int vnet)
     {
         OutputPort *oPort = getOutportForVnet(vnet);
@@ -234,9 +244,11 @@ class NetworkInterface : public ClockedObject, public Consumer
 
           }
 
-          void sendCredit(Credit *cFlit)
+          void
+          sendCredit(int vc, bool is_free_signal, Tick curTime)
           {
-              _outCreditQueue->insert(cFlit);
+              Credit::send(_outCreditQueue, vc, is_free_signal, curTime,
+                           _outCreditLink->coalesceCredits());
           }
 
           uint32_t bitWidth()
@@ -278,6 +290,8 @@ class NetworkInterface : public ClockedObject, public Consumer
     std::vector<InputPort *> inPorts;
     int m_deadlock_threshold;
     std::vector<OutVcState> outVcState;
+    // Bitmask of the idle VCs of outVcState
+    uint64_t m_idle_vcs;
 
     std::vector<int> m_stall_count;
 
@@ -290,13 +304,27 @@ class NetworkInterface : public ClockedObject, public Consumer
     std::vector<MessageBuffer *> inNode_ptr;
     // The Message buffers that provides messages to the protocol
     std::vector<MessageBuffer *> outNode_ptr;
+    // Traffic trace messages waiting for a VC, per vnet
+    std::vector<std::deque<MsgPtr>> m_trace_msgs;
     // When a vc stays busy for a long time, it indicates a deadlock
     std::vector<int> vc_busy_counter;
 
     void checkStallQueue();
     bool flitisizeMessage(MsgPtr msg_ptr, int vnet);
+    bool flitisizeWirelessMulticast(MsgPtr msg_ptr, int vnet,
+                                    OutputPort *oPort);
     int calculateVC(int vnet);
 
+    inline void
+    setVcState(int vc, VC_state_type state)
+    {
+        outVcState[vc].setState(state, curTick());
+        if (state == IDLE_)
+            m_idle_vcs |= (uint64_t(1) << vc);
+        else
+            m_idle_vcs &= ~(uint64_t(1) << vc);
+    }
+
 
     void scheduleOutputPort(OutputPort *oPort);
     void scheduleOutputLink();
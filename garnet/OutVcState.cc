@@ -30,6 +30,7 @@
 
 #include "mem/ruby/network/garnet/OutVcState.hh"
 
+#include "mem/ruby/network/garnet/Router.hh"
 #include "mem/ruby/system/RubySystem.hh"
 
 namespace gem5
@@ -42,7 +43,7 @@ namespace garnet
 {
 
 OutVcState::OutVcState(int id, GarnetNetwork *network_ptr,
-    uint32_t consumerVcs)
+    uint32_t consumerVcs, Router *consumer, PortType consumer_inport_type)
     : m_time(0)
 {
     m_id = id;
@@ -54,7 +55,10 @@ OutVcState::OutVcState(int id, GarnetNetwork *network_ptr,
      */
     int vnet = floor(id/consumerVcs);
 
-    if (network_ptr->get_vnet_type(vnet) == DATA_VNET_)
+    if (consumer != nullptr)
+        m_max_credit_count = consumer->getBuffersPerVC(vnet,
+                                                       consumer_inport_type);
+    else if (network_ptr->get_vnet_type(vnet) == DATA_VNET_)
         m_max_credit_count = network_ptr->getBuffersPerDataVC();
     else
         m_max_credit_count = network_ptr->getBuffersPerCtrlVC();
@@ -64,9 +68,9 @@ OutVcState::OutVcState(int id, GarnetNetwork *network_ptr,
 }
 
 void
-OutVcState::increment_credit()
+OutVcState::increment_credit(int count)
 {
-    m_credit_count++;
+    m_credit_count += count;
     assert(m_credit_count <= m_max_credit_count);
 }
 
@@ -43,14 +43,22 @@ namespace ruby
 namespace garnet
 {
 
+class Router;
+
 class OutVcState
 {
   public:
-    OutVcState(int id, GarnetNetwork *network_ptr, uint32_t consumerVcs);
+    // The credits are the buffers of the VC at the consumer: an inport
+    // of type consumer_inport_type of router consumer, or a network
+    // interface if consumer is null
+    OutVcState(int id, GarnetNetwork *network_ptr, uint32_t consumerVcs,
+               Router *consumer = nullptr,
+               PortType consumer_inport_type = LOCAL_PORT_);
 
     int get_credit_count()          { return m_credit_count; }
+    int get_max_credit_count()      { return m_max_credit_count; }
     inline bool has_credit()       { return (m_credit_count > 0); }
-    void increment_credit();
+    void increment_credit(int count = 1);
     void decrement_credit();
 
     inline bool
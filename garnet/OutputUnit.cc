@@ -31,10 +31,12 @@
 
 #include "mem/ruby/network/garnet/OutputUnit.hh"
 
+#include "base/bitfield.hh"
 #include "debug/RubyNetwork.hh"
 #include "mem/ruby/network/garnet/Credit.hh"
 #include "mem/ruby/network/garnet/CreditLink.hh"
 #include "mem/ruby/network/garnet/Router.hh"
+#include "mem/ruby/network/garnet/WirelessChannel.hh"
 #include "mem/ruby/network/garnet/flitBuffer.hh"
 
 namespace gem5
@@ -47,22 +49,32 @@ namespace garnet
 {
 
 OutputUnit::OutputUnit(int id, PortDirection direction, Router *router,
-  uint32_t consumerVcs)
+  uint32_t consumerVcs, Router *consumer, PortType consumer_inport_type)
   : Consumer(router), m_router(router), m_id(id), m_direction(direction),
-    m_vc_per_vnet(consumerVcs)
+    m_port_type(UNKNOWN_PORT_), m_peer_router(-1), m_peer_inport(-1),
+    m_vc_per_vnet(consumerVcs), m_out_link(nullptr),
+    m_credit_link(nullptr), m_wireless_channel(nullptr)
 {
     const int m_num_vcs = consumerVcs * m_router->get_num_vnets();
+    fatal_if(m_num_vcs > 64, "Router %d: at most 64 VCs per port are "
+             "supported\n", m_router->get_id());
+    m_idle_vcs = mask(m_num_vcs);
     outVcState.reserve(m_num_vcs);
     for (int i = 0; i < m_num_vcs; i++) {
-        outVcState.emplace_back(i, m_router->get_net_ptr(), consumerVcs);
+        outVcState.emplace_back(i, m_router->get_net_ptr(), consumerVcs,
+                                consumer, consumer_inport_type);
     }
 }
 
 void
-OutputUnit::decrement_credit(int out_vc)
+OutputUnit::decrement_credit(int out_vc, int dest_router)
 {
-    std::cout<<"Credit count of "<<m_id<<" "<<m_direction<<" "<<get_credit_count(out_vc)<<"\n";
-    
+    if (m_wireless_channel != nullptr) {
+        m_wireless_channel->decrement_credit(m_router->get_id(), dest_router,
+                                             out_vc);
+        return;
+    }
+
     DPRINTF(RubyNetwork, "Router %d OutputUnit %s decrementing credit:%d for "
             "outvc %d at time: %lld for %s\n", m_router->get_id(),
             m_router->getPortDirectionName(get_direction()),
@@ -73,80 +85,148 @@ OutputUnit::decrement_credit(int out_vc)
 }
 
 void
-OutputUnit::increment_credit(int out_vc)
+OutputUnit::increment_credit(int out_vc, int count)
 {
-    std::cout<<"Credit count of "<<m_id<<" "<<m_direction<<" "<<get_credit_count(out_vc)<<"\n";
-    DPRINTF(RubyNetwork, "Router %d OutputUnit %s incrementing credit:%d for "
-            "outvc %d at time: %lld from:%s\n", m_router->get_id(),
+    DPRINTF(RubyNetwork, "Router %d OutputUnit %s incrementing credit:%d "
+            "by %d for outvc %d at time: %lld from:%s\n", m_router->get_id(),
             m_router->getPortDirectionName(get_direction()),
-            outVcState[out_vc].get_credit_count(),
+            outVcState[out_vc].get_credit_count(), count,
             out_vc, m_router->curCycle(), m_credit_link->name());
 
-    outVcState[out_vc].increment_credit();
+    outVcState[out_vc].increment_credit(count);
 }
 
 // Check if the output VC (i.e., input VC at next router)
 // has free credits (i..e, buffer slots).
 // This is tracked by OutVcState
 bool
-OutputUnit::has_credit(int out_vc)
+OutputUnit::has_credit(int out_vc, int dest_router)
 {
+    if (m_wireless_channel != nullptr)
+        return m_wireless_channel->has_credit(m_router->get_id(),
+                                              dest_router, out_vc);
+
     assert(outVcState[out_vc].isInState(ACTIVE_, curTick()));
     return outVcState[out_vc].has_credit();
 }
 
 
+// Restricts [vc_base, vc_end) of a vnet to its escape VCs (the first
+// ones) or to the adaptive VCs. Ejection never closes a cycle, so both
+// classes share all the VCs of the network interface.
+void
+OutputUnit::vcClassRange(bool escape, int &vc_base, int &vc_end)
+{
+    if (m_port_type == LOCAL_PORT_)
+        return;
+
+    int escape_vcs = m_router->get_net_ptr()->getEscapeVcs();
+    if (escape)
+        vc_end = vc_base + escape_vcs;
+    else
+        vc_base += escape_vcs;
+}
+
+// Bits of the VCs of a vnet in the class of vcClassRange()
+uint64_t
+OutputUnit::vcClassMask(int vnet, bool escape)
+{
+    int vc_base = vnet*m_vc_per_vnet;
+    int vc_end = vc_base + m_vc_per_vnet;
+    vcClassRange(escape, vc_base, vc_end);
+    return mask(vc_end - vc_base) << vc_base;
+}
+
 // Check if the output port (i.e., input port at next router) has free VCs.
+// With escape VCs, either among the escape VCs or among the others.
 bool
-OutputUnit::has_free_vc(int vnet)
+OutputUnit::has_free_vc(int vnet, int dest_router, bool escape)
+{
+    if (m_wireless_channel != nullptr) {
+        assert(!escape);
+        return m_wireless_channel->has_free_vc(m_router->get_id(),
+                                               dest_router, vnet);
+    }
+
+    return (m_idle_vcs & vcClassMask(vnet, escape)) != 0;
+}
+
+// Number of flits buffered downstream in the VCs of this vnet,
+// used as a congestion estimate by adaptive routing
+int
+OutputUnit::get_congestion(int vnet, int dest_router)
 {
+    if (m_wireless_channel != nullptr)
+        return m_wireless_channel->get_congestion(m_router->get_id(),
+                                                  dest_router, vnet);
+
+    int occupancy = 0;
     int vc_base = vnet*m_vc_per_vnet;
     for (int vc = vc_base; vc < vc_base + m_vc_per_vnet; vc++) {
-        if (is_vc_idle(vc, curTick()))
-            return true;
+        occupancy += outVcState[vc].get_max_credit_count() -
+                     outVcState[vc].get_credit_count();
     }
 
-    return false;
+    return occupancy;
+}
+
+int
+OutputUnit::get_free_credits()
+{
+    if (m_wireless_channel != nullptr)
+        return m_wireless_channel->get_free_credits(m_router->get_id());
+
+    int credits = 0;
+    for (auto &vc_state : outVcState)
+        credits += vc_state.get_credit_count();
+    return credits;
 }
 
 // Assign a free output VC to the winner of Switch Allocation
 int
-OutputUnit::select_free_vc(int vnet)
+OutputUnit::select_free_vc(int vnet, int dest_router, bool escape)
 {
-    int vc_base = vnet*m_vc_per_vnet;
-    for (int vc = vc_base; vc < vc_base + m_vc_per_vnet; vc++) {
-        if (is_vc_idle(vc, curTick())) {
-            outVcState[vc].setState(ACTIVE_, curTick());
-            return vc;
-        }
+    if (m_wireless_channel != nullptr) {
+        assert(!escape);
+        return m_wireless_channel->select_free_vc(m_router->get_id(),
+                                                  dest_router, vnet);
     }
 
-    return -1;
+    // The lowest idle VC of the class
+    uint64_t idle = m_idle_vcs & vcClassMask(vnet, escape);
+    if (idle == 0)
+        return -1;
+
+    int vc = findLsbSet(idle);
+    set_vc_state(ACTIVE_, vc, curTick());
+    return vc;
 }
 
 /*
  * The wakeup function of the OutputUnit reads the credit signal from the
  * downstream router for the output VC (i.e., input VC at downstream router).
- * It increments the credit count in the appropriate output VC state.
+ * It increments the credit count in the appropriate output VC state
+ * (by the count of the credit, which may coalesce several of them).
  * If the credit carries is_free_signal as true,
  * the output VC is marked IDLE.
+ * All the credits ready in the cycle are read in one wakeup.
  */
 
 void
 OutputUnit::wakeup()
 {
-    if (m_credit_link->isReady(curTick())) {
+    // Credits of a wireless outport are returned to the channel
+    if (m_credit_link == nullptr)
+        return;
+
+    while (m_credit_link->isReady(curTick())) {
         Credit *t_credit = (Credit*) m_credit_link->consumeLink();
-        increment_credit(t_credit->get_vc());
+        increment_credit(t_credit->get_vc(), t_credit->get_count());
 
         if (t_credit->is_free_signal())
             set_vc_state(IDLE_, t_credit->get_vc(), curTick());
 
         delete t_credit;
-
-        if (m_credit_link->isReady(curTick())) {
-            scheduleEvent(Cycles(1));
-        }
     }
 }
 
@@ -169,17 +249,23 @@ OutputUnit::set_credit_link(CreditLink *credit_link)
 }
 
 void
-OutputUnit::insert_flit(flit *t_flit)
+OutputUnit::set_wireless_channel(WirelessChannel *channel)
 {
-    outBuffer.insert(t_flit);
-    m_out_link->scheduleEventAbsolute(m_router->clockEdge(Cycles(1)));
+    m_wireless_channel = channel;
 }
+
 void
-OutputUnit::insert_flit_wireless(flit *t_flit , Tick c)
+OutputUnit::insert_flit(flit *t_flit)
 {
     outBuffer.insert(t_flit);
-    m_out_link->scheduleEventAbsolute(c);
+    if (m_wireless_channel != nullptr) {
+        m_wireless_channel->
+            scheduleEventAbsolute(m_router->clockEdge(Cycles(1)));
+    } else {
+        m_out_link->scheduleEventAbsolute(m_router->clockEdge(Cycles(1)));
+    }
 }
+
 bool
 OutputUnit::functionalRead(Packet *pkt, WriteMask &mask)
 {
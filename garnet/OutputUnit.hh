@@ -52,25 +52,46 @@ namespace garnet
 
 class CreditLink;
 class Router;
+class WirelessChannel;
 
 class OutputUnit : public Consumer
 {
   public:
     OutputUnit(int id, PortDirection direction, Router *router,
-               uint32_t consumerVcs);
+               uint32_t consumerVcs, Router *consumer = nullptr,
+               PortType consumer_inport_type = LOCAL_PORT_);
     ~OutputUnit() = default;
     void set_out_link(NetworkLink *link);
     void set_credit_link(CreditLink *credit_link);
+    void set_wireless_channel(WirelessChannel *channel);
     void wakeup();
     flitBuffer* getOutQueue();
     void print(std::ostream& out) const {};
-    void decrement_credit(int out_vc);
-    void increment_credit(int out_vc);
-    bool has_credit(int out_vc);
-    bool has_free_vc(int vnet);
-    int select_free_vc(int vnet);
+
+    // dest_router is only used by a wireless outport, where the output
+    // VCs are those of the receiver at dest_router on the channel
+    void decrement_credit(int out_vc, int dest_router = -1);
+    void increment_credit(int out_vc, int count = 1);
+    bool has_credit(int out_vc, int dest_router = -1);
+    bool has_free_vc(int vnet, int dest_router = -1, bool escape = false);
+    int get_congestion(int vnet, int dest_router = -1);
+    // Free buffers over all the output VCs (and receivers)
+    int get_free_credits();
+    int select_free_vc(int vnet, int dest_router = -1, bool escape = false);
 
     inline PortDirection get_direction() { return m_direction; }
+    inline PortType get_port_type() { return m_port_type; }
+    inline int get_peer_router() { return m_peer_router; }
+    // Inport at the peer router, only known for lookahead routing
+    inline int get_peer_inport() { return m_peer_inport; }
+    inline void set_peer_inport(int inport) { m_peer_inport = inport; }
+
+    inline void
+    set_port_info(PortType port_type, int peer_router)
+    {
+        m_port_type = port_type;
+        m_peer_router = peer_router;
+    }
 
     int
     get_credit_count(int vc)
@@ -81,13 +102,23 @@ class OutputUnit : public Consumer
     inline int
     get_outlink_id()
     {
-        return m_out_link->get_id();
+        return (m_out_link != nullptr) ? m_out_link->get_id() : -1;
+    }
+
+    inline WirelessChannel *
+    get_wireless_channel()
+    {
+        return m_wireless_channel;
     }
 
     inline void
     set_vc_state(VC_state_type state, int vc, Tick curTime)
     {
-      outVcState[vc].setState(state, curTime);
+        outVcState[vc].setState(state, curTime);
+        if (state == IDLE_)
+            m_idle_vcs |= (uint64_t(1) << vc);
+        else
+            m_idle_vcs &= ~(uint64_t(1) << vc);
     }
 
     inline bool
@@ -97,7 +128,6 @@ class OutputUnit : public Consumer
     }
 
     void insert_flit(flit *t_flit);
-    void insert_flit_wireless(flit *flit , Tick c);
 
     inline int
     getVcsPerVnet()
@@ -109,17 +139,27 @@ class OutputUnit : public Consumer
     uint32_t functionalWrite(Packet *pkt);
 
   private:
+    void vcClassRange(bool escape, int &vc_base, int &vc_end);
+    uint64_t vcClassMask(int vnet, bool escape);
+
     Router *m_router;
     GEM5_CLASS_VAR_USED int m_id;
     PortDirection m_direction;
+    PortType m_port_type;
+    int m_peer_router;
+    int m_peer_inport;
     int m_vc_per_vnet;
     NetworkLink *m_out_link;
     CreditLink *m_credit_link;
+    WirelessChannel *m_wireless_channel;
 
     // This is for the network link to consume
     flitBuffer outBuffer;
     // vc state of downstream router
     std::vector<OutVcState> outVcState;
+    // Bitmask of the idle VCs of outVcState (the VC states only change
+    // at the current tick, so idle VCs are always idle now)
+    uint64_t m_idle_vcs;
 };
 
 } // namespace garnet
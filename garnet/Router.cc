@@ -32,12 +32,16 @@
 
 #include "mem/ruby/network/garnet/Router.hh"
 
+#include <algorithm>
+
+#include "debug/GarnetWireless.hh"
 #include "debug/RubyNetwork.hh"
 #include "mem/ruby/network/garnet/CreditLink.hh"
 #include "mem/ruby/network/garnet/GarnetNetwork.hh"
 #include "mem/ruby/network/garnet/InputUnit.hh"
 #include "mem/ruby/network/garnet/NetworkLink.hh"
 #include "mem/ruby/network/garnet/OutputUnit.hh"
+#include "mem/ruby/network/garnet/WirelessChannel.hh"
 
 namespace gem5
 {
@@ -51,9 +55,17 @@ namespace garnet
 Router::Router(const Params &p)
   : BasicRouter(p), Consumer(this), m_latency(p.latency),
     m_virtual_networks(p.virt_nets), m_vc_per_vnet(p.vcs_per_vnet),
-    m_num_vcs(m_virtual_networks * m_vc_per_vnet), m_bit_width(p.width),
+    m_num_vcs(m_virtual_networks * m_vc_per_vnet),
+    m_buffers_per_data_vc(p.buffers_per_data_vc),
+    m_buffers_per_ctrl_vc(p.buffers_per_ctrl_vc),
+    m_wireless_buffers_per_data_vc(p.wireless_buffers_per_data_vc ?
+        p.wireless_buffers_per_data_vc : p.buffers_per_data_vc),
+    m_wireless_buffers_per_ctrl_vc(p.wireless_buffers_per_ctrl_vc ?
+        p.wireless_buffers_per_ctrl_vc : p.buffers_per_ctrl_vc),
+    m_bit_width(p.width),
     m_network_ptr(nullptr), routingUnit(this), switchAllocator(this),
-    crossbarSwitch(this)
+    crossbarSwitch(this), m_sa_inports(0), m_wireless_queue(0),
+    m_wireless_queue_since(0)
 {
     m_input_unit.clear();
     m_output_unit.clear();
@@ -66,8 +78,23 @@ Router::init()
 
     switchAllocator.init();
     crossbarSwitch.init();
-    hybrid_connections=m_network_ptr->hybrid_connections;    
+    routingUnit.init();
+}
+
+// A drained router has empty buffers, idle VCs and all its credits, so
+// only the arbitration state is checkpointed
+void
+Router::serialize(CheckpointOut &cp) const
+{
+    switchAllocator.serializeSection(cp, "switch_allocator");
+    routingUnit.serializeSection(cp, "routing_unit");
+}
 
+void
+Router::unserialize(CheckpointIn &cp)
+{
+    switchAllocator.unserializeSection(cp, "switch_allocator");
+    routingUnit.unserializeSection(cp, "routing_unit");
 }
 
 void
@@ -75,8 +102,6 @@ Router::wakeup()
 {
     DPRINTF(RubyNetwork, "Router %d woke up\n", m_id);
     assert(clockEdge() == curTick());
-    token_holder_router=m_network_ptr->get_token_id();
-    std::cout<<"Router wokeup "<<get_id()<<" at the time "<<curTick()<<"\n";
 
     // check for incoming flits
     for (int inport = 0; inport < m_input_unit.size(); inport++) {
@@ -90,25 +115,24 @@ Router::wakeup()
     // if we want the credit update to take place after SA, this loop should
     // be moved after the SA request
     for (int outport = 0; outport < m_output_unit.size(); outport++) {
-        if(m_id==18)
-        {
-        std::cout<<"Out direction "<<m_output_unit[outport]->get_direction()<<"\n";
-        }
         m_output_unit[outport]->wakeup();
     }
 
     // Switch Allocation
-    switchAllocator.wakeup();
+    if (m_sa_inports != 0)
+        switchAllocator.wakeup();
 
     // Switch Traversal
-    crossbarSwitch.wakeup();
+    if (crossbarSwitch.has_flits())
+        crossbarSwitch.wakeup();
 
 
 }
 
 void
 Router::addInPort(PortDirection inport_dirn,
-                  NetworkLink *in_link, CreditLink *credit_link)
+                  NetworkLink *in_link, CreditLink *credit_link,
+                  int peer_router)
 {
     fatal_if(in_link->bitWidth != m_bit_width, "Widths of link %s(%d)does"
             " not match that of Router%d(%d). Consider inserting SerDes "
@@ -116,7 +140,9 @@ Router::addInPort(PortDirection inport_dirn,
 
     int port_num = m_input_unit.size();
     InputUnit *input_unit = new InputUnit(port_num, inport_dirn, this);
+    PortType inport_type = portDirectionToType(inport_dirn);
 
+    input_unit->set_port_info(inport_type, peer_router);
     input_unit->set_in_link(in_link);
     input_unit->set_credit_link(credit_link);
     in_link->setLinkConsumer(this);
@@ -125,23 +151,39 @@ Router::addInPort(PortDirection inport_dirn,
     credit_link->setVcsPerVnet(get_vc_per_vnet());
 
     m_input_unit.push_back(std::shared_ptr<InputUnit>(input_unit));
+    m_inport_type.push_back(inport_type);
 
-    routingUnit.addInDirection(inport_dirn, port_num);
+    routingUnit.addInDirection(inport_dirn, inport_type, port_num);
 }
 
 void
 Router::addOutPort(PortDirection outport_dirn,
                    NetworkLink *out_link,
                    std::vector<NetDest>& routing_table_entry, int link_weight,
-                   CreditLink *credit_link, uint32_t consumerVcs)
+                   CreditLink *credit_link, uint32_t consumerVcs,
+                   int peer_router, PortType peer_inport_type)
 {
     fatal_if(out_link->bitWidth != m_bit_width, "Widths of units do not match."
             " Consider inserting SerDes Units");
 
     int port_num = m_output_unit.size();
+    PortType outport_type = portDirectionToType(outport_dirn);
+
+    // Wireless_Out<id> ports name their peer even if the caller did not
+    if (peer_router == -1 && outport_type == WIRELESS_OUT_PORT_ &&
+        outport_dirn.size() > 12) {
+        peer_router = std::stoi(outport_dirn.substr(12));
+    }
+
+    // The credits of each VC are the buffers of the downstream inport
+    // (of a network interface without a peer router)
+    Router *consumer = (peer_router == -1) ? nullptr :
+        m_network_ptr->getRouter(peer_router);
     OutputUnit *output_unit = new OutputUnit(port_num, outport_dirn, this,
-                                             consumerVcs);
+                                             consumerVcs, consumer,
+                                             peer_inport_type);
 
+    output_unit->set_port_info(outport_type, peer_router);
     output_unit->set_out_link(out_link);
     output_unit->set_credit_link(credit_link);
     credit_link->setLinkConsumer(this);
@@ -150,16 +192,57 @@ Router::addOutPort(PortDirection outport_dirn,
     out_link->setVcsPerVnet(consumerVcs);
 
     m_output_unit.push_back(std::shared_ptr<OutputUnit>(output_unit));
-    std::string wireless="Wireless_Out";
-    if(outport_dirn.find(wireless) !=std::string::npos)
+    m_outport_type.push_back(outport_type);
+    if (outport_type == WIRELESS_OUT_PORT_)
     {
-        m_Wireless_unit.push_back(std::shared_ptr<OutputUnit>(output_unit));
-        std::cout<<"Added wireless out port as "<<output_unit->get_direction()<<" "<<output_unit->get_outlink_id()<<"\n";
+        DPRINTF(GarnetWireless, "Router %d added wireless outport %s "
+                "on link %d\n", m_id, output_unit->get_direction(),
+                output_unit->get_outlink_id());
     }
 
     routingUnit.addRoute(routing_table_entry);
     routingUnit.addWeight(link_weight);
-    routingUnit.addOutDirection(outport_dirn, port_num);
+    routingUnit.addOutDirection(outport_dirn, outport_type, peer_router,
+                                port_num);
+}
+
+/*
+ * The wireless output port has no link and no credit link of its own.
+ * Its flits are picked up by the WirelessChannel, which also keeps the
+ * VC and credit state of all the receivers.
+ */
+void
+Router::addWirelessOutPort(WirelessChannel *channel,
+                           std::vector<NetDest>& routing_table_entry)
+{
+    int port_num = m_output_unit.size();
+    PortDirection outport_dirn =
+        "Wireless_Out_ch" + std::to_string(channel->get_id());
+    OutputUnit *output_unit = new OutputUnit(port_num, outport_dirn, this,
+                                             m_vc_per_vnet);
+
+    output_unit->set_port_info(WIRELESS_OUT_PORT_, -1);
+    output_unit->set_wireless_channel(channel);
+    channel->addTransmitter(m_id, output_unit->getOutQueue());
+
+    m_output_unit.push_back(std::shared_ptr<OutputUnit>(output_unit));
+    m_outport_type.push_back(WIRELESS_OUT_PORT_);
+
+    routingUnit.addRoute(routing_table_entry);
+    routingUnit.addWeight(INFINITE_);
+    routingUnit.addOutDirection(outport_dirn, WIRELESS_OUT_PORT_, -1,
+                                port_num);
+}
+
+uint32_t
+Router::getBuffersPerVC(int vnet, PortType inport_type)
+{
+    if (m_network_ptr->get_vnet_type(vnet) == DATA_VNET_) {
+        return (inport_type == WIRELESS_IN_PORT_) ?
+            m_wireless_buffers_per_data_vc : m_buffers_per_data_vc;
+    }
+    return (inport_type == WIRELESS_IN_PORT_) ?
+        m_wireless_buffers_per_ctrl_vc : m_buffers_per_ctrl_vc;
 }
 
 PortDirection
@@ -174,10 +257,119 @@ Router::getInportDirection(int inport)
     return m_input_unit[inport]->get_direction();
 }
 
+PortType
+Router::portDirectionToType(const PortDirection &direction)
+{
+    if (direction == "Local")
+        return LOCAL_PORT_;
+    if (direction == "North")
+        return NORTH_PORT_;
+    if (direction == "South")
+        return SOUTH_PORT_;
+    if (direction == "East")
+        return EAST_PORT_;
+    if (direction == "West")
+        return WEST_PORT_;
+    if (direction.compare(0, 11, "Wireless_In") == 0)
+        return WIRELESS_IN_PORT_;
+    if (direction.compare(0, 12, "Wireless_Out") == 0)
+        return WIRELESS_OUT_PORT_;
+
+    return UNKNOWN_PORT_;
+}
+
 std::pair<int,int>
-Router::route_compute(RouteInfo route, int inport, PortDirection inport_dirn)
+Router::route_compute(const RouteInfo &route, int inport,
+                      PortType inport_type, int dest_wireless)
+{
+    return routingUnit.outportCompute(route, inport, inport_type,
+                                      dest_wireless);
+}
+
+int
+Router::escape_route_compute(const RouteInfo &route)
+{
+    return routingUnit.outportComputeEscape(route);
+}
+
+// Lookahead routing: computes the outport of the head flit t_flit
+// at the router behind outport, off the critical path of that router.
+// t_flit already carries its outvc and the choice of this router.
+void
+Router::lookahead_route_compute(flit *t_flit, int outport)
+{
+    auto output_unit = getOutputUnit(outport);
+    Router *next = m_network_ptr->getRouter(output_unit->get_peer_router());
+    int inport = output_unit->get_peer_inport();
+    auto input_unit = next->getInputUnit(inport);
+
+    if (input_unit->isEscapeVc(t_flit->get_vc())) {
+        t_flit->set_lookahead(next->escape_route_compute(t_flit->get_route()),
+                              -1);
+    } else {
+        std::pair<int,int> route = next->route_compute(t_flit->get_route(),
+            inport, input_unit->get_port_type(), t_flit->get_dest_wireless());
+        t_flit->set_lookahead(route.first, route.second);
+    }
+}
+
+// The channel token for a shared wireless channel, else the one of the
+// point-to-point wireless links
+WirelessToken *
+Router::getWirelessToken(int outport)
+{
+    assert(getOutportType(outport) == WIRELESS_OUT_PORT_);
+
+    WirelessChannel *channel = m_output_unit[outport]->get_wireless_channel();
+    if (channel != nullptr)
+        return channel->getToken();
+    return m_network_ptr->getWirelessToken();
+}
+
+// Number of packets in the input VCs waiting for a wireless outport
+// (arbitrated by token, or any wireless outport if token is null)
+int
+Router::get_wireless_queue_depth(WirelessToken *token)
 {
-    return routingUnit.outportCompute(route, inport, inport_dirn);
+    if (token == nullptr)
+        return m_wireless_queue;
+
+    for (const auto &token_queue : m_token_queues) {
+        if (token_queue.first == token)
+            return token_queue.second;
+    }
+    return 0;
+}
+
+// Samples the occupancy over the cycles since its last change, so that
+// the histogram is time weighted without per-cycle updates
+void
+Router::update_wireless_queue(int delta, int outport)
+{
+    if (curCycle() > m_wireless_queue_since) {
+        m_wireless_queue_occupancy.sample(m_wireless_queue,
+            curCycle() - m_wireless_queue_since);
+        m_wireless_queue_since = curCycle();
+    }
+    m_wireless_queue += delta;
+    assert(m_wireless_queue >= 0);
+
+    if (delta == 0)
+        return;
+
+    // (one entry per token this router transmits on)
+    WirelessToken *token = getWirelessToken(outport);
+    auto token_queue = std::find_if(m_token_queues.begin(),
+        m_token_queues.end(),
+        [token](const std::pair<WirelessToken *, int> &entry) {
+            return entry.first == token;
+        });
+    if (token_queue == m_token_queues.end()) {
+        m_token_queues.emplace_back(token, 0);
+        token_queue = m_token_queues.end() - 1;
+    }
+    token_queue->second += delta;
+    assert(token_queue->second >= 0);
 }
 
 void
@@ -218,6 +410,14 @@ Router::regStats()
         .flags(statistics::nozero)
     ;
 
+    m_wireless_queue_occupancy
+        .init(16)
+        .name(name() + ".wireless_queue_occupancy")
+        .desc("cycles with each number of packets routed to the "
+              "wireless outports")
+        .flags(statistics::nozero | statistics::pdf)
+    ;
+
     m_buffer_reads
         .name(name() + ".buffer_reads")
         .flags(statistics::nozero)
@@ -260,6 +460,11 @@ Router::collateStats()
     m_sw_output_arbiter_activity =
         switchAllocator.get_output_arbiter_activity();
     m_crossbar_activity = crossbarSwitch.get_crossbar_activity();
+
+    if (std::find(m_outport_type.begin(), m_outport_type.end(),
+                  WIRELESS_OUT_PORT_) != m_outport_type.end()) {
+        update_wireless_queue(0);
+    }
 }
 
 void
@@ -271,6 +476,7 @@ Router::resetStats()
 
     crossbarSwitch.resetStats();
     switchAllocator.resetStats();
+    m_wireless_queue_since = curCycle();
 }
 
 void
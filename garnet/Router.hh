@@ -34,6 +34,7 @@
 
 #include <iostream>
 #include <memory>
+#include <utility>
 #include <vector>
 
 #include "mem/ruby/common/Consumer.hh"
@@ -62,6 +63,7 @@ class NetworkLink;
 class CreditLink;
 class InputUnit;
 class OutputUnit;
+class WirelessChannel;
 
 class Router : public BasicRouter, public Consumer
 {
@@ -70,33 +72,51 @@ class Router : public BasicRouter, public Consumer
     Router(const Params &p);
 
     ~Router() = default;
-    std::vector<std::shared_ptr<OutputUnit>> m_Wireless_unit;
-    int localwirelessreq;
 
     void wakeup();
     void print(std::ostream& out) const {};
 
     void init();
+    void serialize(CheckpointOut &cp) const;
+    void unserialize(CheckpointIn &cp);
+
     void addInPort(PortDirection inport_dirn, NetworkLink *link,
-                   CreditLink *credit_link);
+                   CreditLink *credit_link, int peer_router = -1);
     void addOutPort(PortDirection outport_dirn, NetworkLink *link,
                     std::vector<NetDest>& routing_table_entry,
                     int link_weight, CreditLink *credit_link,
-                    uint32_t consumerVcs);
+                    uint32_t consumerVcs, int peer_router = -1,
+                    PortType peer_inport_type = LOCAL_PORT_);
+    void addWirelessOutPort(WirelessChannel *channel,
+                            std::vector<NetDest>& routing_table_entry);
 
     Cycles get_pipe_stages(){ return m_latency; }
     uint32_t get_num_vcs()       { return m_num_vcs; }
     uint32_t get_num_vnets()     { return m_virtual_networks; }
     uint32_t get_vc_per_vnet()   { return m_vc_per_vnet; }
+    uint32_t getBuffersPerDataVC() { return m_buffers_per_data_vc; }
+    uint32_t getBuffersPerCtrlVC() { return m_buffers_per_ctrl_vc; }
+    // Buffers per VC of vnet at the inports of type inport_type
+    // (the wireless receive ports can be provisioned apart)
+    uint32_t getBuffersPerVC(int vnet, PortType inport_type);
     int get_num_inports()   { return m_input_unit.size(); }
     int get_num_outports()  { return m_output_unit.size(); }
     int get_id()            { return m_id; }
 
+    // Bitmask of the inports holding flits. SA and ST are skipped
+    // while the router has no flit buffered.
+    uint64_t get_sa_inports() const { return m_sa_inports; }
+    void set_sa_inport(int inport) { m_sa_inports |= uint64_t(1) << inport; }
+    void
+    clear_sa_inport(int inport)
+    {
+        m_sa_inports &= ~(uint64_t(1) << inport);
+    }
+
     void init_net_ptr(GarnetNetwork* net_ptr)
     {
         m_network_ptr = net_ptr;
     }
-    int token_holder_router;
 
     GarnetNetwork* get_net_ptr()                    { return m_network_ptr; }
 
@@ -119,8 +139,29 @@ class Router : public BasicRouter, public Consumer
     PortDirection getOutportDirection(int outport);
     PortDirection getInportDirection(int inport);
 
-    std::pair<int,int> route_compute(RouteInfo route, int inport, PortDirection direction);
+    PortType getOutportType(int outport) { return m_outport_type[outport]; }
+    PortType getInportType(int inport) { return m_inport_type[inport]; }
+    static PortType portDirectionToType(const PortDirection &direction);
+
+    std::pair<int,int> route_compute(const RouteInfo &route, int inport,
+                                     PortType inport_type,
+                                     int dest_wireless);
+    int escape_route_compute(const RouteInfo &route);
+    void lookahead_route_compute(flit *t_flit, int outport);
+
+    // Token arbitrating a wireless outport
+    WirelessToken *getWirelessToken(int outport);
+    int get_wireless_queue_depth(WirelessToken *token = nullptr);
+    // Packets routed to the wireless outports (outport, arbitrated
+    // by token) changed by delta
+    void update_wireless_queue(int delta, int outport = -1);
     void grant_switch(int inport, flit *t_flit);
+    // Wireless express bypass (SwitchAllocator::try_bypass)
+    bool
+    try_bypass(int inport, int invc)
+    {
+        return switchAllocator.try_bypass(inport, invc);
+    }
     void schedule_wakeup(Cycles time);
 
     std::string getPortDirectionName(PortDirection direction);
@@ -144,15 +185,17 @@ class Router : public BasicRouter, public Consumer
 
     bool functionalRead(Packet *pkt, WriteMask &mask);
     uint32_t functionalWrite(Packet *);
-    std::unordered_map<int,std::vector<int>> get_hybrid_connections()
+    const std::unordered_map<int, std::vector<int>>&
+    get_hybrid_connections() const
     {
-      return m_network_ptr->hybrid_connections;
+        return m_network_ptr->hybrid_connections;
     }
-    std::unordered_map<int,std::vector<int>>hybrid_connections;
 
   private:
     Cycles m_latency;
     uint32_t m_virtual_networks, m_vc_per_vnet, m_num_vcs;
+    uint32_t m_buffers_per_data_vc, m_buffers_per_ctrl_vc;
+    uint32_t m_wireless_buffers_per_data_vc, m_wireless_buffers_per_ctrl_vc;
     uint32_t m_bit_width;
     GarnetNetwork *m_network_ptr;
 
@@ -163,12 +206,25 @@ class Router : public BasicRouter, public Consumer
     std::vector<std::shared_ptr<InputUnit>> m_input_unit;
     std::vector<std::shared_ptr<OutputUnit>> m_output_unit;
 
+    // Port types, indexed by port number
+    std::vector<PortType> m_inport_type;
+    std::vector<PortType> m_outport_type;
+    uint64_t m_sa_inports;
+
+    // Packets routed to the wireless outports, and since when
+    int m_wireless_queue;
+    Cycles m_wireless_queue_since;
+    // Packets routed to the wireless outports of each token
+    std::vector<std::pair<WirelessToken *, int>> m_token_queues;
 
     // Statistical variables required for power computations
     statistics::Scalar m_buffer_reads;
     statistics::Scalar m_buffer_writes;
     statistics::Scalar m_wireless_request;
     statistics::Scalar m_wireless_transfer;
+    // Cycles spent with each number of packets waiting for the wireless
+    // outports (hybrid routers only)
+    statistics::Histogram m_wireless_queue_occupancy;
 
     statistics::Scalar m_sw_input_arbiter_activity;
     statistics::Scalar m_sw_output_arbiter_activity;
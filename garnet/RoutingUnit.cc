@@ -30,11 +30,16 @@
 
 #include "mem/ruby/network/garnet/RoutingUnit.hh"
 
+#include <sstream>
+
 #include "base/cast.hh"
 #include "base/compiler.hh"
+#include "debug/GarnetWireless.hh"
 #include "debug/RubyNetwork.hh"
 #include "mem/ruby/network/garnet/InputUnit.hh"
+#include "mem/ruby/network/garnet/OutputUnit.hh"
 #include "mem/ruby/network/garnet/Router.hh"
+#include "mem/ruby/network/garnet/WirelessChannel.hh"
 #include "mem/ruby/slicc_interface/Message.hh"
 
 namespace gem5
@@ -51,7 +56,97 @@ RoutingUnit::RoutingUnit(Router *router)
     m_router = router;
     m_routing_table.clear();
     m_weight_table.clear();
+    m_hybrid_route_table.clear();
+    m_num_nodes = 0;
+    m_rng.seed(router->get_id() + 1);
+    std::fill(m_outports_type2idx, m_outports_type2idx + NUM_PORT_TYPE_, -1);
+}
+
+/*
+ * Called from Router::init() once all the ports have been added.
+ * Compiles the routing table. With the custom algorithm and
+ * hybrid_route_table set, the search over hybrid router pairs is done
+ * once per destination router here, so that route computation for a
+ * packet becomes a single table lookup.
+ */
+void
+RoutingUnit::init()
+{
+    compileRoutingTable();
+
+    GarnetNetwork *net_ptr = m_router->get_net_ptr();
+    RoutingAlgorithm routing_algorithm =
+        (RoutingAlgorithm) net_ptr->getRoutingAlgorithm();
+    if (!net_ptr->isMesh() &&
+        (routing_algorithm == CUSTOM_ || routing_algorithm == ADAPTIVE_)) {
+        compileWiredNextHops();
+    }
+
+    if (!net_ptr->isHybridRouteTableEnabled() ||
+        routing_algorithm != CUSTOM_) {
+        return;
+    }
+
+    int num_routers = net_ptr->getNumRouters();
+    m_hybrid_route_table.assign(num_routers, std::make_pair(-1, -1));
+
+    for (int dest = 0; dest < num_routers; dest++) {
+        if (dest == m_router->get_id())
+            continue;
+
+        RouteInfo route;
+        route.dest_router = dest;
+        m_hybrid_route_table[dest] =
+            searchHybridRoute(route, -1, LOCAL_PORT_);
+    }
+}
+
+// First outport of a shortest wired path to every router (the lowest
+// weight, then the lowest index among the equal ones), used by the
+// hybrid routing outside of a mesh
+void
+RoutingUnit::compileWiredNextHops()
+{
+    GarnetNetwork *net_ptr = m_router->get_net_ptr();
+    int num_routers = net_ptr->getNumRouters();
+    int my_id = m_router->get_id();
+
+    m_wired_next_hop.assign(num_routers, -1);
+    for (int dest = 0; dest < num_routers; dest++) {
+        int hops = net_ptr->getHops(my_id, dest);
+        if (dest == my_id || hops == GarnetNetwork::UNREACHABLE_HOPS)
+            continue;
+
+        for (int outport = 0; outport < m_router->get_num_outports();
+             outport++) {
+            int peer = m_router->getOutputUnit(outport)->get_peer_router();
+            if (peer == -1 ||
+                m_router->getOutportType(outport) == WIRELESS_OUT_PORT_ ||
+                net_ptr->getHops(peer, dest) != hops - 1) {
+                continue;
+            }
+            int best = m_wired_next_hop[dest];
+            if (best == -1 || m_weight_table[outport] < m_weight_table[best])
+                m_wired_next_hop[dest] = outport;
+        }
+    }
+}
+
+void
+RoutingUnit::serialize(CheckpointOut &cp) const
+{
+    std::ostringstream rng;
+    rng << m_rng;
+    paramOut(cp, "rng", rng.str());
+}
 
+void
+RoutingUnit::unserialize(CheckpointIn &cp)
+{
+    std::string state;
+    paramIn(cp, "rng", state);
+    std::istringstream rng(state);
+    rng >> m_rng;
 }
 
 void
@@ -93,71 +188,89 @@ RoutingUnit::supportsVnet(int vnet, std::vector<int> sVnets)
  * The routing table is populated during topology creation.
  * Routes can be biased via weight assignments in the topology file.
  * Correct weight assignments are critical to provide deadlock avoidance.
+ *
+ * The table is compiled by compileRoutingTable() at init, so a lookup
+ * only picks one of the precomputed candidates of the destination node.
  */
 int
-RoutingUnit::lookupRoutingTable(int vnet, NetDest msg_destination)
+RoutingUnit::lookupRoutingTable(int vnet, NodeID dest_node)
 {
-    // First find all possible output link candidates
     // For ordered vnet, just choose the first
     // (to make sure different packets don't choose different routes)
     // For unordered vnet, randomly choose any of the links
     // To have a strict ordering between links, they should be given
     // different weights in the topology file
+    const std::vector<int> &candidates =
+        m_route_candidates[vnet * m_num_nodes + dest_node];
+    fatal_if(candidates.empty(), "No route exists from router %d to "
+             "node %d in vnet %d\n", m_router->get_id(), dest_node, vnet);
 
-    int output_link = -1;
-    int min_weight = INFINITE_;
-    std::vector<int> output_link_candidates;
-    int num_candidates = 0;
-
-    // Identify the minimum weight among the candidate output links
-    for (int link = 0; link < m_routing_table[vnet].size(); link++) {
-        if (msg_destination.intersectionIsNotEmpty(
-            m_routing_table[vnet][link])) {
+    if (candidates.size() == 1 ||
+        m_router->get_net_ptr()->isVNetOrdered(vnet))
+        return candidates[0];
 
-        if (m_weight_table[link] <= min_weight)
-            min_weight = m_weight_table[link];
-        }
-    }
-
-    // Collect all candidate output links with this minimum weight
-    for (int link = 0; link < m_routing_table[vnet].size(); link++) {
-        if (msg_destination.intersectionIsNotEmpty(
-            m_routing_table[vnet][link])) {
+    return candidates[m_rng() % candidates.size()];
+}
 
-            if (m_weight_table[link] == min_weight) {
-                num_candidates++;
-                output_link_candidates.push_back(link);
+/*
+ * For every vnet and destination node, collects the output links of
+ * minimum weight whose NetDest holds the node, in outport order.
+ */
+void
+RoutingUnit::compileRoutingTable()
+{
+    m_num_nodes = MachineType_base_number(MachineType_NUM);
+    m_route_candidates.assign(m_routing_table.size() * m_num_nodes, {});
+
+    for (int vnet = 0; vnet < m_routing_table.size(); vnet++) {
+        for (int m = 0; m < (int) MachineType_NUM; m++) {
+            MachineType type = (MachineType) m;
+            for (int i = 0; i < MachineType_base_count(type); i++) {
+                MachineID machine = {type, (NodeID) i};
+                std::vector<int> &candidates = m_route_candidates[
+                    vnet * m_num_nodes + MachineType_base_number(type) + i];
+
+                int min_weight = INFINITE_;
+                for (int link = 0; link < m_routing_table[vnet].size();
+                     link++) {
+                    if (!m_routing_table[vnet][link].isElement(machine))
+                        continue;
+                    if (m_weight_table[link] < min_weight) {
+                        min_weight = m_weight_table[link];
+                        candidates.clear();
+                    }
+                    if (m_weight_table[link] == min_weight)
+                        candidates.push_back(link);
+                }
             }
         }
     }
-
-    if (output_link_candidates.size() == 0) {
-        fatal("Fatal Error:: No Route exists from this Router.");
-        exit(0);
-    }
-
-    // Randomly select any candidate output link
-    int candidate = 0;
-    if (!(m_router->get_net_ptr())->isVNetOrdered(vnet))
-        candidate = rand() % num_candidates;
-
-    output_link = output_link_candidates.at(candidate);
-    return output_link;
 }
 
 
 void
-RoutingUnit::addInDirection(PortDirection inport_dirn, int inport_idx)
+RoutingUnit::addInDirection(PortDirection inport_dirn,
+                            PortType inport_type, int inport_idx)
 {
     m_inports_dirn2idx[inport_dirn] = inport_idx;
     m_inports_idx2dirn[inport_idx]  = inport_dirn;
 }
 
 void
-RoutingUnit::addOutDirection(PortDirection outport_dirn, int outport_idx)
+RoutingUnit::addOutDirection(PortDirection outport_dirn,
+                             PortType outport_type, int peer_router,
+                             int outport_idx)
 {
     m_outports_dirn2idx[outport_dirn] = outport_idx;
     m_outports_idx2dirn[outport_idx]  = outport_dirn;
+    m_outports_type2idx[outport_type] = outport_idx;
+
+    if (outport_type == WIRELESS_OUT_PORT_) {
+        if (peer_router == -1)
+            m_wireless_channel_outports.push_back(outport_idx);
+        else
+            m_wireless_outports_idx[peer_router] = outport_idx;
+    }
 }
 
 
@@ -168,18 +281,30 @@ RoutingUnit::addOutDirection(PortDirection outport_dirn, int outport_idx)
 // table is provided here.
 
 std::pair<int,int>
-RoutingUnit::outportCompute(RouteInfo route, int inport,
-                            PortDirection inport_dirn)
+RoutingUnit::outportCompute(const RouteInfo &route, int inport,
+                            PortType inport_type, int dest_wireless)
 {
     int outport = -1;
     int dest_hybrid_router=-1;
 
+    // A wireless multicast packet follows the wired path to the
+    // hybrid router broadcasting it (route.dest_router)
+    if (dest_wireless == WIRELESS_MULTICAST_) {
+        if (route.dest_router == m_router->get_id()) {
+            outport = selectWirelessChannel(route.vnet,
+                                            WIRELESS_MULTICAST_);
+        } else {
+            outport = outportComputeWired(route, inport, inport_type);
+        }
+        return std::make_pair(outport, WIRELESS_MULTICAST_);
+    }
+
     if (route.dest_router == m_router->get_id()) {
 
         // Multiple NIs may be connected to this router,
         // all with output port direction = "Local"
         // Get exact outport id from table
-        outport = lookupRoutingTable(route.vnet, route.net_dest);
+        outport = lookupRoutingTable(route.vnet, route.dest_ni);
         return std::make_pair(outport,dest_hybrid_router);
     }
 
@@ -190,30 +315,73 @@ RoutingUnit::outportCompute(RouteInfo route, int inport,
 
     switch (routing_algorithm) {
         case TABLE_:  outport =
-            lookupRoutingTable(route.vnet, route.net_dest); break;
+            lookupRoutingTable(route.vnet, route.dest_ni); break;
         case XY_:     outport =
-            outportComputeXY(route, inport, inport_dirn); break;
+            outportComputeXY(route, inport, inport_type); break;
         // any custom algorithm
-        case CUSTOM_: {std::tie(outport, dest_hybrid_router) = outportComputeCustom(route, inport, inport_dirn);
+        case CUSTOM_: {std::tie(outport, dest_hybrid_router) = outportComputeCustom(route, inport, inport_type);
         break;
     }
+        case ADAPTIVE_: std::tie(outport, dest_hybrid_router) =
+            outportComputeAdaptive(route, inport, inport_type,
+                                   dest_wireless); break;
         default: outport =
-            lookupRoutingTable(route.vnet, route.net_dest); break;
+            lookupRoutingTable(route.vnet, route.dest_ni); break;
+    }
+
+    // The hybrid route only names the receiving hybrid router,
+    // pick the wireless channel per packet
+    if (dest_hybrid_router != -1 &&
+        m_router->getOutportType(outport) == WIRELESS_OUT_PORT_ &&
+        !m_wireless_channel_outports.empty()) {
+        outport = selectWirelessChannel(route.vnet, dest_hybrid_router);
     }
 
     assert(outport != -1);
     return std::make_pair(outport,dest_hybrid_router);
 }
 
+// Among the wireless channels shared with dest_hybrid_router, pick the
+// one with the fewest flits buffered at the receiver plus token wait.
+// Multicast packets reach all hybrid routers on any channel, only the
+// token wait is compared.
+int
+RoutingUnit::selectWirelessChannel(int vnet, int dest_hybrid_router)
+{
+    int best_outport = -1;
+    int best_cost = std::numeric_limits<int>::max();
+    bool multicast = (dest_hybrid_router == WIRELESS_MULTICAST_);
+
+    for (int outport : m_wireless_channel_outports) {
+        WirelessChannel *channel =
+            m_router->getOutputUnit(outport)->get_wireless_channel();
+        if (!multicast &&
+            channel->getTransceiverIdx(dest_hybrid_router) == -1)
+            continue;
+
+        int cost = channel->getToken()->expectedWait(m_router->get_id());
+        if (!multicast)
+            cost += channel->get_congestion(m_router->get_id(),
+                                            dest_hybrid_router, vnet);
+        if (cost < best_cost) {
+            best_cost = cost;
+            best_outport = outport;
+        }
+    }
+
+    assert(best_outport != -1);
+    return best_outport;
+}
+
 // XY routing implemented using port directions
 // Only for reference purpose in a Mesh
 // By default Garnet uses the routing table
 int
-RoutingUnit::outportComputeXY(RouteInfo route,
+RoutingUnit::outportComputeXY(const RouteInfo &route,
                               int inport,
-                              PortDirection inport_dirn)
+                              PortType inport_type)
 {
-    PortDirection outport_dirn = "Unknown";
+    PortType outport_type = UNKNOWN_PORT_;
 
     [[maybe_unused]] int num_rows = m_router->get_net_ptr()->getNumRows();
     int num_cols = m_router->get_net_ptr()->getNumCols();
@@ -238,21 +406,23 @@ RoutingUnit::outportComputeXY(RouteInfo route,
 
     if (x_hops > 0) {
         if (x_dirn) {
-            assert(inport_dirn == "Local" || inport_dirn == "West" || inport_dirn =="Wireless_In");
-            outport_dirn = "East";
+            assert(inport_type == LOCAL_PORT_ || inport_type == WEST_PORT_ ||
+                   inport_type == WIRELESS_IN_PORT_);
+            outport_type = EAST_PORT_;
         } else {
-            assert(inport_dirn == "Local" || inport_dirn == "East" || inport_dirn == "Wireless_In");
-            outport_dirn = "West";
+            assert(inport_type == LOCAL_PORT_ || inport_type == EAST_PORT_ ||
+                   inport_type == WIRELESS_IN_PORT_);
+            outport_type = WEST_PORT_;
         }
     } else if (y_hops > 0) {
         if (y_dirn) {
             // "Local" or "South" or "West" or "East"
-            assert(inport_dirn != "North");
-            outport_dirn = "North";
+            assert(inport_type != NORTH_PORT_);
+            outport_type = NORTH_PORT_;
         } else {
             // "Local" or "North" or "West" or "East"
-            assert(inport_dirn != "South");
-            outport_dirn = "South";
+            assert(inport_type != SOUTH_PORT_);
+            outport_type = SOUTH_PORT_;
         }
     } else {
         // x_hops == 0 and y_hops == 0
@@ -261,55 +431,160 @@ RoutingUnit::outportComputeXY(RouteInfo route,
         panic("x_hops == y_hops == 0");
     }
 
-    return m_outports_dirn2idx[outport_dirn];
+    assert(m_outports_type2idx[outport_type] != -1);
+    return m_outports_type2idx[outport_type];
+}
+
+// Wired outport towards route.dest_router: XY in a mesh, else the
+// first hop of a shortest wired path
+int
+RoutingUnit::outportComputeWired(const RouteInfo &route,
+                                 int inport,
+                                 PortType inport_type)
+{
+    if (m_router->get_net_ptr()->isMesh())
+        return outportComputeXY(route, inport, inport_type);
+
+    assert(route.dest_router < m_wired_next_hop.size());
+    int outport = m_wired_next_hop[route.dest_router];
+    fatal_if(outport == -1, "Router %d has no wired path to router %d\n",
+             m_router->get_id(), route.dest_router);
+    return outport;
+}
+
+// Escape path: wired XY from this router to the destination. Unlike
+// outportComputeXY the packet may have arrived from any direction,
+// since an adaptive packet may switch to the escape VCs at any hop.
+int
+RoutingUnit::outportComputeEscape(const RouteInfo &route)
+{
+    if (route.dest_router == m_router->get_id())
+        return lookupRoutingTable(route.vnet, route.dest_ni);
+
+    int num_cols = m_router->get_net_ptr()->getNumCols();
+    assert(num_cols > 0);
+
+    int my_id = m_router->get_id();
+    int dest_id = route.dest_router;
+    int x_diff = dest_id % num_cols - my_id % num_cols;
+    int y_diff = dest_id / num_cols - my_id / num_cols;
+
+    PortType outport_type;
+    if (x_diff != 0)
+        outport_type = (x_diff > 0) ? EAST_PORT_ : WEST_PORT_;
+    else
+        outport_type = (y_diff > 0) ? NORTH_PORT_ : SOUTH_PORT_;
+
+    assert(m_outports_type2idx[outport_type] != -1);
+    return m_outports_type2idx[outport_type];
 }
 
 // Template for implementing custom routing algorithm
 // using port directions. (Example adaptive)
 std::pair<int,int>
-RoutingUnit::outportComputeCustom(RouteInfo route,
+RoutingUnit::outportComputeCustom(const RouteInfo &route,
                                  int inport,
-                                 PortDirection inport_dirn)
+                                 PortType inport_type)
 {
- PortDirection outport_dirn = "Unknown";
+    if (!m_hybrid_route_table.empty()) {
+        assert(route.dest_router < m_hybrid_route_table.size());
+        return m_hybrid_route_table[route.dest_router];
+    }
 
-    int num_cols = m_router->get_net_ptr()->getNumCols();
-    int my_id = m_router->get_id();
-    int my_x = my_id % num_cols;
-    int my_y = my_id / num_cols;
+    return searchHybridRoute(route, inport, inport_type);
+}
 
-    int dest_id = route.dest_router;
-    int dest_x = dest_id % num_cols;
-    int dest_y = dest_id / num_cols;
+// Congestion-aware variant of the custom algorithm.
+// The static hybrid route is only taken if its estimated delay, i.e.,
+// hops plus the downstream occupancy of its first outport, the wireless
+// packets queued at the transmitting hybrid router and the expected
+// token wait, is below the one of the XY route.
+// A packet that took the wired XY path at a previous router, or that
+// already crossed the wireless channel, stays on XY so the choice
+// cannot oscillate.
+// A packet heading to its source hybrid router may have arrived from
+// any direction, so its wired alternative is computed like the escape
+// path (XY from this router) in a mesh.
+std::pair<int,int>
+RoutingUnit::outportComputeAdaptive(const RouteInfo &route,
+                                    int inport,
+                                    PortType inport_type,
+                                    int dest_wireless)
+{
+    if (inport_type == WIRELESS_IN_PORT_ ||
+        (inport_type != LOCAL_PORT_ && dest_wireless == -1)) {
+        return std::make_pair(
+            outportComputeWired(route, inport, inport_type), -1);
+    }
 
+    GarnetNetwork *net_ptr = m_router->get_net_ptr();
+    int xy_outport = net_ptr->isMesh() ? outportComputeEscape(route) :
+        outportComputeWired(route, inport, inport_type);
 
+    int src_hybrid_router = -1;
+    std::pair<int,int> hybrid_route =
+        searchHybridRoute(route, inport, inport_type, &src_hybrid_router);
+    if (hybrid_route.second == -1)
+        return std::make_pair(xy_outport, -1);
 
-    // std::unordered_map<int, std::vector<int>> hybrid_connections = {
-    //     {18, {45, 50, 21}},
-    //     {45, {18, 50, 21}},
-    //     {50, {45, 18, 21}},
-    //     {21, {45, 50, 18}}
-    // };
-    hybrid_connections=m_router->get_hybrid_connections();
+    auto calculateHops = [&](int src_id, int dst_id) {
+        return net_ptr->getHops(src_id, dst_id);
+    };
+
+    int my_id = m_router->get_id();
+    int vnet = route.vnet;
+
+    int xy_delay = calculateHops(my_id, route.dest_router) +
+        m_router->getOutputUnit(xy_outport)->get_congestion(vnet);
+
+    int hybrid_outport = hybrid_route.first;
+    int dest_router =
+        (m_router->getOutportType(hybrid_outport) == WIRELESS_OUT_PORT_) ?
+        hybrid_route.second : -1;
+    int hybrid_delay = calculateHops(my_id, src_hybrid_router) + 1 +
+        calculateHops(hybrid_route.second, route.dest_router) +
+        m_router->getOutputUnit(hybrid_outport)->
+            get_congestion(vnet, dest_router) +
+        net_ptr->getRouter(src_hybrid_router)->get_wireless_queue_depth() +
+        net_ptr->expectedTokenWait(src_hybrid_router);
+
+    if (hybrid_delay < xy_delay)
+        return hybrid_route;
+
+    return std::make_pair(xy_outport, -1);
+}
 
+std::pair<int,int>
+RoutingUnit::searchHybridRoute(const RouteInfo &route,
+                               int inport,
+                               PortType inport_type,
+                               int *src_hybrid_router)
+{
+    PortType outport_type = UNKNOWN_PORT_;
+
+    GarnetNetwork *net_ptr = m_router->get_net_ptr();
+    int my_id = m_router->get_id();
+    int dest_id = route.dest_router;
+
+    const std::unordered_map<int, std::vector<int>> &hybrid_connections =
+        m_router->get_hybrid_connections();
+
+    // Wired hops (Manhattan distance in a mesh)
     auto calculateHops = [&](int src_id, int dst_id) {
-        int src_x = src_id % num_cols;
-        int src_y = src_id / num_cols;
-        int dst_x = dst_id % num_cols;
-        int dst_y = dst_id / num_cols;
-        return abs(dst_x - src_x) + abs(dst_y - src_y);
+        return net_ptr->getHops(src_id, dst_id);
     };
 
-    // Calculate hops for XY routing
+    // Calculate hops for the wired (XY in a mesh) routing
     int xy_hops = calculateHops(my_id, dest_id);
 
     // Calculate hops for hybrid routing
     int hybrid_hops = std::numeric_limits<int>::max();
     int best_hybrid_router = -1;
     int dest_hybrid_router = -1;
-    if (hybrid_connections.find(my_id) != hybrid_connections.end()) {
+    auto my_connections = hybrid_connections.find(my_id);
+    if (my_connections != hybrid_connections.end()) {
         // If we're already at a hybrid router, calculate hops directly
-        for (int connected_router : hybrid_connections[my_id]) {
+        for (int connected_router : my_connections->second) {
             int hops = calculateHops(connected_router, dest_id) + 1; // +1 for the wireless hop
             if (hops < hybrid_hops) {
                 hybrid_hops = hops;
@@ -336,32 +611,58 @@ RoutingUnit::outportComputeCustom(RouteInfo route,
         }
     }
 
-    // std::cout<<" My Id = "<<my_id<<", Dst Id = "<<dest_id<<", XY hops = "<<xy_hops<<", Hybrid hops = "<<hybrid_hops<<std::endl;
+    DPRINTF(GarnetWireless, "Router %d to %d: wired hops %d, hybrid hops "
+            "%d\n", my_id, dest_id, xy_hops, hybrid_hops);
+
+    if (src_hybrid_router != nullptr) {
+        *src_hybrid_router =
+            (my_connections != hybrid_connections.end()) ? my_id :
+            best_hybrid_router;
+    }
 
     // Choose the routing method with fewer hops
     if (hybrid_hops < xy_hops) {
         // Use hybrid routing
-        if (hybrid_connections.find(my_id)!=hybrid_connections.end()) {
-                std::string dir="Wireless_Out"+std::to_string(dest_hybrid_router);
-                std::cout<<"Out dir form routing unit "<<dir<<"/n";
-                return std::make_pair(m_outports_dirn2idx[dir],dest_hybrid_router);
+        if (my_connections != hybrid_connections.end()) {
+                // A point-to-point wireless link to the peer if one
+                // exists, else the port onto the shared wireless channel
+                auto wireless_outport =
+                    m_wireless_outports_idx.find(dest_hybrid_router);
+                int outport = (wireless_outport !=
+                               m_wireless_outports_idx.end()) ?
+                    wireless_outport->second :
+                    m_outports_type2idx[WIRELESS_OUT_PORT_];
+                assert(outport != -1);
+                return std::make_pair(outport, dest_hybrid_router);
         } 
+        else if (!net_ptr->isMesh()) {
+            // Route towards the nearest hybrid router
+            assert(m_wired_next_hop[best_hybrid_router] != -1);
+            return std::make_pair(m_wired_next_hop[best_hybrid_router],
+                                  dest_hybrid_router);
+        }
         else {
             // Route towards the nearest hybrid router
+            int num_cols = net_ptr->getNumCols();
+            int my_x = my_id % num_cols;
+            int my_y = my_id / num_cols;
             int next_x = best_hybrid_router % num_cols;
             int next_y = best_hybrid_router / num_cols;
-            bool x_dirn = (next_x >= my_x);
-            bool y_dirn = (next_y >= my_y);
-            if (next_x > my_x) outport_dirn="East";
-            else if (next_x < my_x) outport_dirn="West";
-            else if (next_y > my_y) outport_dirn="North";
-            else if (next_y < my_y) outport_dirn="South";
-
-
-    return std::make_pair(m_outports_dirn2idx[outport_dirn],dest_hybrid_router);
+            if (next_x > my_x) outport_type = EAST_PORT_;
+            else if (next_x < my_x) outport_type = WEST_PORT_;
+            else if (next_y > my_y) outport_type = NORTH_PORT_;
+            else if (next_y < my_y) outport_type = SOUTH_PORT_;
+
+            assert(m_outports_type2idx[outport_type] != -1);
+            return std::make_pair(m_outports_type2idx[outport_type],
+                                  dest_hybrid_router);
         }
     }
-    return std::make_pair(outportComputeXY(route, inport, inport_dirn),-1);
+    // (possibly arrived from any direction on its way to a hybrid router)
+    if (net_ptr->isMesh())
+        return std::make_pair(outportComputeEscape(route), -1);
+    return std::make_pair(outportComputeWired(route, inport, inport_type),
+                          -1);
 }
 
 } // namespace garnet
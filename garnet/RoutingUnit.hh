@@ -31,11 +31,14 @@
 #ifndef __MEM_RUBY_NETWORK_GARNET_0_ROUTINGUNIT_HH__
 #define __MEM_RUBY_NETWORK_GARNET_0_ROUTINGUNIT_HH__
 
+#include <random>
+
 #include "mem/ruby/common/Consumer.hh"
 #include "mem/ruby/common/NetDest.hh"
 #include "mem/ruby/network/garnet/CommonTypes.hh"
 #include "mem/ruby/network/garnet/GarnetNetwork.hh"
 #include "mem/ruby/network/garnet/flit.hh"
+#include "sim/serialize.hh"
 
 namespace gem5
 {
@@ -49,53 +52,109 @@ namespace garnet
 class InputUnit;
 class Router;
 
-class RoutingUnit
+class RoutingUnit : public Serializable
 {
   public:
     RoutingUnit(Router *router);
-    std::pair<int,int> outportCompute(RouteInfo route,
+    void init();
+    // State of the candidate picker
+    void serialize(CheckpointOut &cp) const;
+    void unserialize(CheckpointIn &cp);
+    std::pair<int,int> outportCompute(const RouteInfo &route,
                       int inport,
-                      PortDirection inport_dirn);
+                      PortType inport_type,
+                      int dest_wireless);
 
     // Topology-agnostic Routing Table based routing (default)
     void addRoute(std::vector<NetDest>& routing_table_entry);
     void addWeight(int link_weight);
 
     // get output port from routing table
-    int  lookupRoutingTable(int vnet, NetDest net_dest);
+    int  lookupRoutingTable(int vnet, NodeID dest_node);
 
     // Topology-specific direction based routing
-    void addInDirection(PortDirection inport_dirn, int inport);
-    void addOutDirection(PortDirection outport_dirn, int outport);
+    void addInDirection(PortDirection inport_dirn, PortType inport_type,
+                        int inport);
+    void addOutDirection(PortDirection outport_dirn, PortType outport_type,
+                         int peer_router, int outport);
 
     // Routing for Mesh
-    int outportComputeXY(RouteInfo route,
+    int outportComputeXY(const RouteInfo &route,
                          int inport,
-                         PortDirection inport_dirn);
+                         PortType inport_type);
+
+    // Wired path of the hybrid routing: XY in a mesh, else a shortest
+    // path of the hop matrix (GarnetNetwork::getHops)
+    int outportComputeWired(const RouteInfo &route,
+                            int inport,
+                            PortType inport_type);
+
+    // Deadlock free escape path (XY) of the escape VCs
+    int outportComputeEscape(const RouteInfo &route);
 
     // Custom Routing Algorithm using Port Directions
-    std::pair<int,int> outportComputeCustom(RouteInfo route,
+    std::pair<int,int> outportComputeCustom(const RouteInfo &route,
                              int inport,
-                             PortDirection inport_dirn);
+                             PortType inport_type);
+
+    // Custom Routing weighing the hybrid path by live congestion
+    std::pair<int,int> outportComputeAdaptive(const RouteInfo &route,
+                                              int inport,
+                                              PortType inport_type,
+                                              int dest_wireless);
+
+    // Search over all hybrid router pairs used by the custom routing
+    // algorithm. Either called per packet or once per destination
+    // to fill the precomputed hybrid route table.
+    // Optionally returns the hybrid router transmitting on the channel.
+    std::pair<int,int> searchHybridRoute(const RouteInfo &route,
+                                         int inport,
+                                         PortType inport_type,
+                                         int *src_hybrid_router = nullptr);
+
+    // Wireless channel outport towards dest_hybrid_router
+    int selectWirelessChannel(int vnet, int dest_hybrid_router);
 
     // Returns true if vnet is present in the vector
     // of vnets or if the vector supports all vnets.
     bool supportsVnet(int vnet, std::vector<int> sVnets);
-  std::unordered_map<int,std::vector<int>>hybrid_connections;
 
   private:
     Router *m_router;
 
+    void compileRoutingTable();
+    void compileWiredNextHops();
+
     // Routing Table
     std::vector<std::vector<NetDest>> m_routing_table;
     std::vector<int> m_weight_table;
 
+    // Compiled routing table: minimum weight outports indexed by
+    // vnet * m_num_nodes + destination node
+    std::vector<std::vector<int>> m_route_candidates;
+    int m_num_nodes;
+    // Picks among the candidates of unordered vnets
+    std::minstd_rand m_rng;
+
     // Inport and Outport direction to idx maps
     std::map<PortDirection, int> m_inports_dirn2idx;
     std::map<int, PortDirection> m_inports_idx2dirn;
     std::map<int, PortDirection> m_outports_idx2dirn;
     std::map<PortDirection, int> m_outports_dirn2idx;
+    // Wireless outport idx by peer hybrid router
     std::map<int,int> m_wireless_outports_idx;
+    // Outports onto shared wireless channels
+    std::vector<int> m_wireless_channel_outports;
+    // Outport idx by port type (last port added of each type)
+    int m_outports_type2idx[NUM_PORT_TYPE_];
+
+    // First wired outport towards each router (-1: none), outside of
+    // a mesh only
+    std::vector<int> m_wired_next_hop;
+
+    // Precomputed hybrid routes indexed by destination router:
+    // {outport, dest_hybrid_router}. Empty unless enabled.
+    std::vector<std::pair<int,int>> m_hybrid_route_table;
 };
 
 } // namespace garnet
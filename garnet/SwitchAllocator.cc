@@ -31,6 +31,7 @@
 
 #include "mem/ruby/network/garnet/SwitchAllocator.hh"
 
+#include "base/bitfield.hh"
 #include "debug/RubyNetwork.hh"
 #include "mem/ruby/network/garnet/GarnetNetwork.hh"
 #include "mem/ruby/network/garnet/InputUnit.hh"
@@ -64,20 +65,49 @@ SwitchAllocator::init()
     m_num_outports = m_router->get_num_outports();
     m_round_robin_inport.resize(m_num_outports);
     m_round_robin_invc.resize(m_num_inports);
-    m_port_requests.resize(m_num_inports);
+    m_outport_requests.resize(m_num_outports);
     m_vc_winners.resize(m_num_inports);
+    m_inport_bypass_time.assign(m_num_inports, MaxTick);
+    m_outport_bypass_time.assign(m_num_outports, MaxTick);
+
+    GarnetNetwork *net_ptr = m_router->get_net_ptr();
+    m_qos = (net_ptr->getArbitration() == enums::ARB_QOS);
+    m_starvation_ticks =
+        m_router->cyclesToTicks(Cycles(net_ptr->getQosStarvationCycles()));
+
+    // Requests are kept as one bit per inport
+    fatal_if(m_num_inports > 64, "Router %d: at most 64 inports are "
+             "supported by the switch allocator\n", m_router->get_id());
 
     for (int i = 0; i < m_num_inports; i++) {
         m_round_robin_invc[i] = 0;
-        m_port_requests[i] = -1;
         m_vc_winners[i] = -1;
     }
 
     for (int i = 0; i < m_num_outports; i++) {
         m_round_robin_inport[i] = 0;
+        m_outport_requests[i] = 0;
     }
 }
 
+void
+SwitchAllocator::serialize(CheckpointOut &cp) const
+{
+    SERIALIZE_CONTAINER(m_round_robin_invc);
+    SERIALIZE_CONTAINER(m_round_robin_inport);
+}
+
+void
+SwitchAllocator::unserialize(CheckpointIn &cp)
+{
+    UNSERIALIZE_CONTAINER(m_round_robin_invc);
+    UNSERIALIZE_CONTAINER(m_round_robin_inport);
+    fatal_if(m_round_robin_invc.size() != m_num_inports ||
+             m_round_robin_inport.size() != m_num_outports,
+             "Router %d: the checkpoint has other ports\n",
+             m_router->get_id());
+}
+
 /*
  * The wakeup function of the SwitchAllocator performs a 2-stage
  * seperable switch allocation. At the end of the 2nd stage, a free
@@ -105,50 +135,101 @@ SwitchAllocator::wakeup()
  *    - For BODY/TAIL flits, only selects an input VC that has credits
  *      in its output VC.
  * Places a request for the output port from this input VC.
+ * With ARB_QOS, the VC selected is the first one in round robin order
+ * among the qos_before() best VCs that may be sent.
  */
 
 void
 SwitchAllocator::arbitrate_inports()
 {
     // Select a VC from each input in a round robin manner
-    // Independent arbiter at each input port
-    for (int inport = 0; inport < m_num_inports; inport++) {
+    // Independent arbiter at each input port (holding flits)
+    for (uint64_t inports = m_router->get_sa_inports(); inports != 0;
+         inports &= inports - 1) {
+        int inport = findLsbSet(inports);
+        auto input_unit = m_router->getInputUnit(inport);
+
+        // The inport already sent a bypassing flit this cycle
+        if (m_inport_bypass_time[inport] == curTick())
+            continue;
 
-        int invc = m_round_robin_invc[inport];
+        // Only the VCs holding flits are visited
+        uint64_t sa_vcs = input_unit->get_sa_vcs();
+        int qos_winner = -1;
+        bool qos_escape = false;
 
-        for (int invc_iter = 0; invc_iter < m_num_vcs; invc_iter++) {
-            auto input_unit = m_router->getInputUnit(inport);
+        while (sa_vcs != 0) {
+            int invc = roundRobinPick(sa_vcs, m_round_robin_invc[inport]);
+            sa_vcs &= ~(uint64_t(1) << invc);
 
             if (input_unit->need_stage(invc, SA_, curTick())) {
                 // This flit is in SA stage
-            std::string out_dir = m_router->getOutportDirection(input_unit->get_outport(invc));
-            if(m_router->token_holder_router != m_router->get_id() && out_dir.find("Wireless_Out")==!+std::string::npos)
-            {
-                std::cout<<"from router "<<m_router->get_id()<<" Cant transmit wireless because token is with "<<m_router->token_holder_router<<"\n";
-            }
-            else{
-
-                int outport = input_unit->get_outport(invc);
-                int outvc = input_unit->get_outvc(invc);
-
-                // check if the flit in this InputVC is allowed to be sent
-                // send_allowed conditions described in that function.
-                bool make_request =
-                    send_allowed(inport, invc, outport, outvc);
-
-                if (make_request) {
-                    m_input_arbiter_activity++;
-                    m_port_requests[inport] = outport;
-                    m_vc_winners[inport] = invc;
-
-                    break; // got one vc winner for this port
+                // Only the token holder may transmit on a wireless outport
+                int wireless_outport = input_unit->get_outport(invc);
+                WirelessToken *token =
+                    (m_router->getOutportType(wireless_outport) ==
+                     WIRELESS_OUT_PORT_) ?
+                    m_router->getWirelessToken(wireless_outport) : nullptr;
+                if (token != nullptr && !token->holds(m_router->get_id())) {
+                    token->request(m_router->get_id(),
+                                   m_qos && qos_class(input_unit, invc) > 0);
+                    input_unit->wait_token(invc);
+                } else {
+                    if (token != nullptr)
+                        input_unit->hold_token(invc);
+
+                    int outport = input_unit->get_outport(invc);
+                    int outvc = input_unit->get_outvc(invc);
+
+                    // The outport is taken by a bypassing flit this cycle
+                    if (m_outport_bypass_time[outport] == curTick())
+                        continue;
+
+                    // check if the flit in this InputVC is allowed to be sent
+                    // send_allowed conditions described in that function.
+                    bool make_request =
+                        send_allowed(inport, invc, outport, outvc);
+
+                    // A blocked head flit of an adaptive packet falls back
+                    // to the escape path when its escape VC is free (with
+                    // QoS, only once it wins the inport)
+                    bool escape = false;
+                    if (!make_request && outvc == -1 &&
+                        !input_unit->get_use_escape(invc) &&
+                        can_take_escape(input_unit, invc)) {
+                        escape = true;
+                        make_request = true;
+                    }
+
+                    if (make_request && m_qos) {
+                        if (qos_winner == -1 ||
+                            qos_before(input_unit, invc,
+                                       input_unit, qos_winner)) {
+                            qos_winner = invc;
+                            qos_escape = escape;
+                        }
+                    } else if (make_request) {
+                        if (escape) {
+                            input_unit->take_escape(invc);
+                            outport = input_unit->get_outport(invc);
+                        }
+                        m_input_arbiter_activity++;
+                        m_outport_requests[outport] |= (uint64_t(1) << inport);
+                        m_vc_winners[inport] = invc;
+
+                        break; // got one vc winner for this port
+                    }
                 }
             }
-            }
+        }
 
-            invc++;
-            if (invc >= m_num_vcs)
-                invc = 0;
+        if (qos_winner != -1) {
+            if (qos_escape)
+                input_unit->take_escape(qos_winner);
+            int outport = input_unit->get_outport(qos_winner);
+            m_input_arbiter_activity++;
+            m_outport_requests[outport] |= (uint64_t(1) << inport);
+            m_vc_winners[inport] = qos_winner;
         }
     }
 }
@@ -156,7 +237,8 @@ SwitchAllocator::arbitrate_inports()
 /*
  * SA-II (or SA-o) loops through all output ports,
  * and selects one input VC (that placed a request during SA-I)
- * as the winner for this output port in a round robin manner.
+ * as the winner for this output port in a round robin manner
+ * (with ARB_QOS, the first qos_before() best one in round robin order).
  *      - For HEAD/HEAD_TAIL flits, performs simplified outvc allocation.
  *        (i.e., select a free VC from the output port).
  *      - For BODY/TAIL flits, decrement a credit in the output vc.
@@ -174,124 +256,172 @@ SwitchAllocator::arbitrate_outports()
     // Again do round robin arbitration on these requests
     // Independent arbiter at each output port
     for (int outport = 0; outport < m_num_outports; outport++) {
-        int inport = m_round_robin_inport[outport];
-
-        for (int inport_iter = 0; inport_iter < m_num_inports;
-                 inport_iter++) {
-
-            // inport has a request this cycle for outport
-            if (m_port_requests[inport] == outport) {
-                auto output_unit = m_router->getOutputUnit(outport);
-                auto input_unit = m_router->getInputUnit(inport);
-
-                // grant this outport to this inport
-                int invc = m_vc_winners[inport];
-
-                int outvc = input_unit->get_outvc(invc);
-                if (outvc == -1) {
-                    // VC Allocation - select any free VC from outport
-                    outvc = vc_allocate(outport, inport, invc);
-                    // if(m_router->getOutportDirection(outport)=="Wireless_Out")
-                    // {
-                    //     for(int i=0;i<m_router->m_Wireless_unit.size();i++)
-                    //     {
-                    //         if(output_unit->get_outlink_id() != m_router->m_Wireless_unit[i]->get_outlink_id())
-                    //         {
-                    //             m_router->m_Wireless_unit[i]->set_vc_state(ACTIVE_,outvc,curTick());
-                    //         }
-                    //     }
-                    // }
-                }
+        // inports with a request this cycle for outport
+        uint64_t requests = m_outport_requests[outport];
+
+        if (requests != 0) {
+            int inport = m_qos ?
+                qosPick(requests, m_round_robin_inport[outport]) :
+                roundRobinPick(requests, m_round_robin_inport[outport]);
+            // grant this outport to this inport
+            int invc = m_vc_winners[inport];
+
+            send_flit(inport, invc, outport);
+            m_output_arbiter_activity++;
+
+            // remove the requests for this outport
+            m_outport_requests[outport] = 0;
+
+            // Update Round Robin pointer
+            m_round_robin_inport[outport] = inport + 1;
+            if (m_round_robin_inport[outport] >= m_num_inports)
+                m_round_robin_inport[outport] = 0;
+
+            // Update Round Robin pointer to the next VC
+            // We do it here to keep it fair.
+            // Only the VC which got switch traversal
+            // is updated.
+            m_round_robin_invc[inport] = invc + 1;
+            if (m_round_robin_invc[inport] >= m_num_vcs)
+                m_round_robin_invc[inport] = 0;
+        }
+    }
+}
 
-                // remove flit from Input VC
-                flit *t_flit = input_unit->getTopFlit(invc);
-
-                DPRINTF(RubyNetwork, "SwitchAllocator at Router %d "
-                                     "granted outvc %d at outport %d "
-                                     "to invc %d at inport %d to flit %s at "
-                                     "cycle: %lld\n",
-                        m_router->get_id(), outvc,
-                        m_router->getPortDirectionName(
-                            output_unit->get_direction()),
-                        invc,
-                        m_router->getPortDirectionName(
-                            input_unit->get_direction()),
-                            *t_flit,
-                        m_router->curCycle());
-
-
-                // Update outport field in the flit since this is
-                // used by CrossbarSwitch code to send it out of
-                // correct outport.
-                // Note: post route compute in InputUnit,
-                // outport is updated in VC, but not in flit
-                t_flit->set_outport(outport);
-
-                // set outvc (i.e., invc for next hop) in flit
-                // (This was updated in VC by vc_allocate, but not in flit)
-                t_flit->set_vc(outvc);
-                // t_flit->set_dest_wireless(input_unit->get_wireless_dest_vc(invc));
-
-                // decrement credit in outvc
-                // if(m_router->getOutportDirection(outport)=="Wireless_Out")
-                // {
-                //     for(int i=0;i<m_router->m_Wireless_unit.size();i++)
-                //     {
-                //         m_router->m_Wireless_unit[i]->decrement_credit(outvc);
-                //     }
-                // }                
-                // else{
-                output_unit->decrement_credit(outvc);
-                // }
-
-                // flit ready for Switch Traversal
-                t_flit->advance_stage(ST_, curTick());
-                m_router->grant_switch(inport, t_flit);
-                m_output_arbiter_activity++;
-
-                if ((t_flit->get_type() == TAIL_) ||
-                    t_flit->get_type() == HEAD_TAIL_) {
-
-                    // This Input VC should now be empty
-                    assert(!(input_unit->isReady(invc, curTick())));
-
-                    // Free this VC
-                    input_unit->set_vc_idle(invc, curTick());
-
-                    // Send a credit back
-                    // along with the information that this VC is now idle
-                    input_unit->increment_credit(invc, true, curTick());
-                } else {
-                    // Send a credit back
-                    // but do not indicate that the VC is idle
-                    input_unit->increment_credit(invc, false, curTick());
-                }
+/*
+ * Sends the flit at the head of invc of inport through outport.
+ *      - For HEAD/HEAD_TAIL flits, performs simplified outvc allocation.
+ *      - For BODY/TAIL flits, decrement a credit in the output vc.
+ * The flit is read out from the input VC and sent to the CrossbarSwitch,
+ * and a credit goes back upstream.
+ */
+void
+SwitchAllocator::send_flit(int inport, int invc, int outport)
+{
+    auto output_unit = m_router->getOutputUnit(outport);
+    auto input_unit = m_router->getInputUnit(inport);
+
+    int outvc = input_unit->get_outvc(invc);
+    if (outvc == -1) {
+        // VC Allocation - select any free VC from outport
+        outvc = vc_allocate(outport, inport, invc);
+    }
 
-                // remove this request
-                m_port_requests[inport] = -1;
+    // remove flit from Input VC
+    flit *t_flit = input_unit->getTopFlit(invc);
+
+    DPRINTF(RubyNetwork, "SwitchAllocator at Router %d "
+                         "granted outvc %d at outport %d "
+                         "to invc %d at inport %d to flit %s at "
+                         "cycle: %lld\n",
+            m_router->get_id(), outvc,
+            m_router->getPortDirectionName(
+                output_unit->get_direction()),
+            invc,
+            m_router->getPortDirectionName(
+                input_unit->get_direction()),
+                *t_flit,
+            m_router->curCycle());
+
+
+    // Update outport field in the flit since this is
+    // used by CrossbarSwitch code to send it out of
+    // correct outport.
+    // Note: post route compute in InputUnit,
+    // outport is updated in VC, but not in flit
+    t_flit->set_outport(outport);
+
+    // set outvc (i.e., invc for next hop) in flit
+    // (This was updated in VC by vc_allocate, but not in flit)
+    t_flit->set_vc(outvc);
+
+    // Route computation of the next router, if done here
+    if (output_unit->get_peer_inport() != -1 &&
+        (t_flit->get_type() == HEAD_ ||
+         t_flit->get_type() == HEAD_TAIL_)) {
+        m_router->lookahead_route_compute(t_flit, outport);
+    }
+    m_router->get_net_ptr()->traceFlit(TRACE_SA_GRANT_, t_flit,
+        m_router->get_id(), outport);
+
+    // decrement credit in outvc
+    // (for the wireless outport, in the VC of the receiver)
+    output_unit->decrement_credit(outvc,
+        input_unit->get_wireless_dest_vc(invc));
+
+    // token wait of the packet (the VC may be freed below)
+    if (m_router->getOutportType(outport) == WIRELESS_OUT_PORT_ &&
+        (t_flit->get_type() == HEAD_ ||
+         t_flit->get_type() == HEAD_TAIL_)) {
+        m_router->get_net_ptr()->sample_token_wait(
+            t_flit->get_vnet(), m_router->ticksToCycles(
+                input_unit->get_token_wait(invc)));
+    }
 
-                // Update Round Robin pointer
-                m_round_robin_inport[outport] = inport + 1;
-                if (m_round_robin_inport[outport] >= m_num_inports)
-                    m_round_robin_inport[outport] = 0;
+    // flit ready for Switch Traversal
+    t_flit->advance_stage(ST_, curTick());
+    m_router->grant_switch(inport, t_flit);
 
-                // Update Round Robin pointer to the next VC
-                // We do it here to keep it fair.
-                // Only the VC which got switch traversal
-                // is updated.
-                m_round_robin_invc[inport] = invc + 1;
-                if (m_round_robin_invc[inport] >= m_num_vcs)
-                    m_round_robin_invc[inport] = 0;
+    if ((t_flit->get_type() == TAIL_) ||
+        t_flit->get_type() == HEAD_TAIL_) {
 
+        // This Input VC should now be empty
+        assert(!(input_unit->isReady(invc, curTick())));
 
-                break; // got a input winner for this outport
-            }
+        // Free this VC
+        input_unit->set_vc_idle(invc, curTick());
 
-            inport++;
-            if (inport >= m_num_inports)
-                inport = 0;
+        // Send a credit back
+        // along with the information that this VC is now idle
+        input_unit->increment_credit(invc, true, curTick());
+    } else {
+        // Send a credit back
+        // but do not indicate that the VC is idle
+        input_unit->increment_credit(invc, false, curTick());
+    }
+
+    // Let the token arbiter know how the tenure goes
+    if (m_router->getOutportType(outport) ==
+        WIRELESS_OUT_PORT_) {
+        if (t_flit->get_type() == TAIL_ ||
+            t_flit->get_type() == HEAD_TAIL_) {
+            m_router->update_wireless_queue(-1, outport);
         }
+
+        WirelessToken *token = m_router->getWirelessToken(outport);
+        token->flitSent(m_router->get_id(), t_flit->get_type(),
+            m_router->get_wireless_queue_depth(token) > 0);
+    }
+}
+
+/*
+ * Wireless express bypass: a flit arriving alone in its VC on a
+ * wireless receive port skips the buffer wait and SA, and goes to
+ * switch traversal in its arrival cycle, if its outport is wired, is
+ * not bypassed to by another inport this cycle and has a free outvc
+ * (or a credit for BODY/TAIL flits). The bypassed inport and outport are
+ * left out of SA in that cycle. Ordered vnets are never bypassed, since
+ * the flits waiting in the pipeline are not seen by the ordering check.
+ */
+bool
+SwitchAllocator::try_bypass(int inport, int invc)
+{
+    auto input_unit = m_router->getInputUnit(inport);
+    int outport = input_unit->get_outport(invc);
+    Tick now = curTick();
+
+    if (m_router->getOutportType(outport) == WIRELESS_OUT_PORT_ ||
+        m_outport_bypass_time[outport] == now ||
+        m_inport_bypass_time[inport] == now ||
+        m_router->get_net_ptr()->isVNetOrdered(get_vnet(invc)) ||
+        !send_allowed(inport, invc, outport, input_unit->get_outvc(invc))) {
+        return false;
     }
+
+    m_outport_bypass_time[outport] = now;
+    m_inport_bypass_time[inport] = now;
+    send_flit(inport, invc, outport);
+    return true;
 }
 
 /*
@@ -319,13 +449,27 @@ SwitchAllocator::send_allowed(int inport, int invc, int outport, int outvc)
     bool has_outvc = (outvc != -1);
     bool has_credit = false;
 
+    // receiver of the packet on the wireless channel, if any
+    int dest_router = m_router->getInputUnit(inport)->
+        get_wireless_dest_vc(invc);
+
     auto output_unit = m_router->getOutputUnit(outport);
     if (!has_outvc) {
 
         // needs outvc
         // this is only true for HEAD and HEAD_TAIL flits.
-
-        if (output_unit->has_free_vc(vnet)) {
+        // A wireless multicast flit needs one VC per destination on
+        // the channel (on its wired hops, an ordinary VC).
+        bool fork = (dest_router == WIRELESS_MULTICAST_ &&
+            m_router->getOutportType(outport) == WIRELESS_OUT_PORT_);
+        bool has_free_vc = fork ?
+            output_unit->get_wireless_channel()->has_free_fork_vcs(
+                m_router->get_id(),
+                m_router->getInputUnit(inport)->peekTopFlit(invc)) :
+            output_unit->has_free_vc(vnet, dest_router,
+                m_router->getInputUnit(inport)->get_use_escape(invc));
+
+        if (has_free_vc) {
 
             has_outvc = true;
 
@@ -334,7 +478,7 @@ SwitchAllocator::send_allowed(int inport, int invc, int outport, int outvc)
             has_credit = true;
         }
     } else {
-        has_credit = output_unit->has_credit(outvc);
+        has_credit = output_unit->has_credit(outvc, dest_router);
     }
 
     // cannot send if no outvc or no credit.
@@ -365,13 +509,86 @@ SwitchAllocator::send_allowed(int inport, int invc, int outport, int outvc)
     return true;
 }
 
+// ARB_QOS class of the packet in invc: 2 if it arrived at least
+// qos_starvation_cycles ago, 1 for control packets (single-flit or on
+// a control vnet), 0 otherwise
+int
+SwitchAllocator::qos_class(InputUnit *input_unit, int invc)
+{
+    if (curTick() - input_unit->get_enqueue_time(invc) >= m_starvation_ticks)
+        return 2;
+
+    int vnet = get_vnet(invc);
+    if (m_router->get_net_ptr()->get_vnet_type(vnet) == CTRL_VNET_ ||
+        input_unit->peekTopFlit(invc)->get_size() == 1)
+        return 1;
+    return 0;
+}
+
+// Whether the packet in invc_a is served before the one in invc_b:
+// higher class first, then the one that arrived first
+bool
+SwitchAllocator::qos_before(InputUnit *input_a, int invc_a,
+                            InputUnit *input_b, int invc_b)
+{
+    int class_a = qos_class(input_a, invc_a);
+    int class_b = qos_class(input_b, invc_b);
+    if (class_a != class_b)
+        return class_a > class_b;
+    return input_a->get_enqueue_time(invc_a) <
+        input_b->get_enqueue_time(invc_b);
+}
+
+// SA-II winner among the inports in requests: the qos_before() best
+// VC winner, the first in round robin order from start among equals
+int
+SwitchAllocator::qosPick(uint64_t requests, int start)
+{
+    int best = -1;
+    while (requests != 0) {
+        int inport = roundRobinPick(requests, start);
+        requests &= ~(uint64_t(1) << inport);
+        if (best == -1 ||
+            qos_before(m_router->getInputUnit(inport), m_vc_winners[inport],
+                       m_router->getInputUnit(best), m_vc_winners[best]))
+            best = inport;
+    }
+    return best;
+}
+
+// Escape path of the head flit in invc, if enabled and deadlock free:
+// ordered vnets keep their route and multicast has no escape path
+bool
+SwitchAllocator::can_take_escape(InputUnit *input_unit, int invc)
+{
+    int escape_outport = input_unit->get_escape_outport(invc);
+    int vnet = get_vnet(invc);
+    if (escape_outport == -1 ||
+        m_router->get_net_ptr()->isVNetOrdered(vnet))
+        return false;
+
+    return m_router->getOutputUnit(escape_outport)->
+        has_free_vc(vnet, -1, true);
+}
+
 // Assign a free VC to the winner of the output port.
 int
 SwitchAllocator::vc_allocate(int outport, int inport, int invc)
 {
     // Select a free VC from the output port
-    int outvc =
-        m_router->getOutputUnit(outport)->select_free_vc(get_vnet(invc));
+    int dest_router = m_router->getInputUnit(inport)->
+        get_wireless_dest_vc(invc);
+    int outvc;
+    if (dest_router == WIRELESS_MULTICAST_ &&
+        m_router->getOutportType(outport) == WIRELESS_OUT_PORT_) {
+        outvc = m_router->getOutputUnit(outport)->get_wireless_channel()->
+            select_fork_vcs(m_router->get_id(),
+                            m_router->getInputUnit(inport)->peekTopFlit(invc));
+    } else {
+        outvc = m_router->getOutputUnit(outport)->
+            select_free_vc(get_vnet(invc), dest_router,
+                m_router->getInputUnit(inport)->get_use_escape(invc));
+    }
 
     // has to get a valid VC since it checked before performing SA
     assert(outvc != -1);
@@ -390,9 +607,15 @@ SwitchAllocator::check_for_wakeup()
         return;
     }
 
-    for (int i = 0; i < m_num_inports; i++) {
-        for (int j = 0; j < m_num_vcs; j++) {
-            if (m_router->getInputUnit(i)->need_stage(j, SA_, nextCycle)) {
+    for (uint64_t inports = m_router->get_sa_inports(); inports != 0;
+         inports &= inports - 1) {
+        int inport = findLsbSet(inports);
+        auto input_unit = m_router->getInputUnit(inport);
+        for (uint64_t sa_vcs = input_unit->get_sa_vcs(); sa_vcs != 0;
+             sa_vcs &= sa_vcs - 1) {
+            int invc = findLsbSet(sa_vcs);
+            if (input_unit->need_stage(invc, SA_, nextCycle) &&
+                !waits_for_token(inport, invc)) {
                 m_router->schedule_wakeup(Cycles(1));
                 return;
             }
@@ -400,6 +623,29 @@ SwitchAllocator::check_for_wakeup()
     }
 }
 
+// True if the flit in invc requested the token of its wireless outport.
+// The token wakes the router up once it gets there.
+bool
+SwitchAllocator::waits_for_token(int inport, int invc)
+{
+    int outport = m_router->getInputUnit(inport)->get_outport(invc);
+    if (m_router->getOutportType(outport) != WIRELESS_OUT_PORT_)
+        return false;
+
+    WirelessToken *token = m_router->getWirelessToken(outport);
+    return token->requested(m_router->get_id());
+}
+
+// First bit set in mask at or after start, wrapping around.
+// mask must not be empty.
+int
+SwitchAllocator::roundRobinPick(uint64_t mask, int start)
+{
+    assert(mask != 0 && start < 64);
+    uint64_t from_start = mask & (~uint64_t(0) << start);
+    return findLsbSet(from_start != 0 ? from_start : mask);
+}
+
 int
 SwitchAllocator::get_vnet(int invc)
 {
@@ -414,7 +660,7 @@ SwitchAllocator::get_vnet(int invc)
 void
 SwitchAllocator::clear_request_vector()
 {
-    std::fill(m_port_requests.begin(), m_port_requests.end(), -1);
+    std::fill(m_outport_requests.begin(), m_outport_requests.end(), 0);
 }
 
 void
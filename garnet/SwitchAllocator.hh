@@ -37,6 +37,7 @@
 
 #include "mem/ruby/common/Consumer.hh"
 #include "mem/ruby/network/garnet/CommonTypes.hh"
+#include "sim/serialize.hh"
 
 namespace gem5
 {
@@ -51,12 +52,15 @@ class Router;
 class InputUnit;
 class OutputUnit;
 
-class SwitchAllocator : public Consumer
+class SwitchAllocator : public Consumer, public Serializable
 {
   public:
     SwitchAllocator(Router *router);
     void wakeup();
     void init();
+    // Round robin priorities (the requests are empty once drained)
+    void serialize(CheckpointOut &cp) const;
+    void unserialize(CheckpointIn &cp);
     void clear_request_vector();
     void check_for_wakeup();
     int get_vnet (int invc);
@@ -64,7 +68,19 @@ class SwitchAllocator : public Consumer
     void arbitrate_inports();
     void arbitrate_outports();
     bool send_allowed(int inport, int invc, int outport, int outvc);
+    void send_flit(int inport, int invc, int outport);
+    // Wireless express bypass of a flit that just arrived
+    bool try_bypass(int inport, int invc);
     int vc_allocate(int outport, int inport, int invc);
+    bool waits_for_token(int inport, int invc);
+    bool can_take_escape(InputUnit *input_unit, int invc);
+    static int roundRobinPick(uint64_t mask, int start);
+
+    // ARB_QOS arbitration
+    int qos_class(InputUnit *input_unit, int invc);
+    bool qos_before(InputUnit *input_a, int invc_a,
+                    InputUnit *input_b, int invc_b);
+    int qosPick(uint64_t requests, int start);
 
     inline double
     get_input_arbiter_activity()
@@ -86,10 +102,16 @@ class SwitchAllocator : public Consumer
     double m_input_arbiter_activity, m_output_arbiter_activity;
 
     Router *m_router;
+    bool m_qos;
+    Tick m_starvation_ticks;
     std::vector<int> m_round_robin_invc;
     std::vector<int> m_round_robin_inport;
-    std::vector<int> m_port_requests;
+    // Bitmask of the inports requesting each outport
+    std::vector<uint64_t> m_outport_requests;
     std::vector<int> m_vc_winners;
+    // Tick of the last bypass through each inport and outport
+    std::vector<Tick> m_inport_bypass_time;
+    std::vector<Tick> m_outport_bypass_time;
 };
 
 } // namespace garnet
@@ -0,0 +1,170 @@
+/*
+ * Copyright (c) 2024 The gem5_garnet_wireless authors
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+#include "mem/ruby/network/garnet/TrafficTrace.hh"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+
+#include "base/logging.hh"
+#include "mem/ruby/network/garnet/GarnetNetwork.hh"
+#include "sim/cur_tick.hh"
+
+namespace gem5
+{
+
+namespace ruby
+{
+
+namespace garnet
+{
+
+void
+TraceMessage::print(std::ostream& out) const
+{
+    out << "[TraceMessage: Destination=" << m_destination
+        << " MessageSize=" << m_size << "]";
+}
+
+TrafficTrace::TrafficTrace(GarnetNetwork *net_ptr,
+                           const std::string &filename, uint32_t prefetch)
+    : m_net_ptr(net_ptr), m_filename(filename), m_records(nullptr),
+      m_num_records(0), m_next(0), m_mapped_bytes(0),
+      m_prefetch(std::max(prefetch, 1u)), m_advised(0),
+      m_event([this]{ inject(); }, "GarnetTrafficTrace")
+{
+    int fd = open(filename.c_str(), O_RDONLY);
+    fatal_if(fd < 0, "Cannot open traffic trace %s: %s\n", filename,
+             strerror(errno));
+
+    struct stat st;
+    fatal_if(fstat(fd, &st) != 0, "Cannot stat traffic trace %s: %s\n",
+             filename, strerror(errno));
+    fatal_if(st.st_size % sizeof(TrafficTraceRecord) != 0,
+             "Traffic trace %s is not a sequence of %d byte records\n",
+             filename, sizeof(TrafficTraceRecord));
+
+    m_mapped_bytes = st.st_size;
+    m_num_records = st.st_size / sizeof(TrafficTraceRecord);
+    if (m_mapped_bytes > 0) {
+        void *addr = mmap(nullptr, m_mapped_bytes, PROT_READ, MAP_PRIVATE,
+                          fd, 0);
+        fatal_if(addr == MAP_FAILED, "Cannot map traffic trace %s: %s\n",
+                 filename, strerror(errno));
+        madvise(addr, m_mapped_bytes, MADV_SEQUENTIAL);
+        m_records = static_cast<const TrafficTraceRecord *>(addr);
+    }
+    close(fd);
+}
+
+TrafficTrace::~TrafficTrace()
+{
+    if (m_records)
+        munmap(const_cast<TrafficTraceRecord *>(m_records), m_mapped_bytes);
+}
+
+void
+TrafficTrace::start()
+{
+    if (m_next >= m_num_records || m_event.scheduled())
+        return;
+    advise(m_next);
+    m_net_ptr->schedule(m_event, std::max(Tick(m_records[m_next].tick),
+                                          curTick()));
+}
+
+void
+TrafficTrace::pause()
+{
+    if (m_event.scheduled())
+        m_net_ptr->deschedule(m_event);
+}
+
+void
+TrafficTrace::serialize(CheckpointOut &cp) const
+{
+    paramOut(cp, "next_record", m_next);
+}
+
+// A checkpoint taken without this trace replays it from the start
+void
+TrafficTrace::unserialize(CheckpointIn &cp)
+{
+    optParamIn(cp, "next_record", m_next);
+    fatal_if(m_next > m_num_records, "Traffic trace %s has %d records, "
+             "the checkpoint is at record %d\n", m_filename,
+             m_num_records, m_next);
+}
+
+// Every prefetch records: read ahead the next window and release the
+// window already replayed
+void
+TrafficTrace::advise(size_t record)
+{
+    if (record < m_advised)
+        return;
+
+    const size_t page = sysconf(_SC_PAGESIZE);
+    const char *base = reinterpret_cast<const char *>(m_records);
+    size_t done = (record * sizeof(TrafficTraceRecord)) / page * page;
+    if (done > 0)
+        madvise(const_cast<char *>(base), done, MADV_DONTNEED);
+
+    size_t end = std::min(record + m_prefetch, m_num_records);
+    size_t ahead = end * sizeof(TrafficTraceRecord) - done;
+    madvise(const_cast<char *>(base) + done, ahead, MADV_WILLNEED);
+    m_advised = end;
+}
+
+void
+TrafficTrace::inject()
+{
+    Tick tick = m_records[m_next].tick;
+    while (m_next < m_num_records && m_records[m_next].tick <= curTick()) {
+        const TrafficTraceRecord &rec = m_records[m_next];
+        fatal_if(rec.tick < tick, "Traffic trace %s: record %d is not "
+                 "sorted by tick\n", m_filename, m_next);
+        tick = rec.tick;
+        m_net_ptr->injectTraceRecord(rec);
+        advise(++m_next);
+    }
+
+    if (m_next < m_num_records)
+        m_net_ptr->schedule(m_event, m_records[m_next].tick);
+}
+
+} // namespace garnet
+} // namespace ruby
+} // namespace gem5
@@ -0,0 +1,139 @@
+/*
+ * Copyright (c) 2024 The gem5_garnet_wireless authors
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+#ifndef __MEM_RUBY_NETWORK_GARNET_0_TRAFFICTRACE_HH__
+#define __MEM_RUBY_NETWORK_GARNET_0_TRAFFICTRACE_HH__
+
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+#include <memory>
+#include <string>
+
+#include "base/types.hh"
+#include "mem/ruby/common/NetDest.hh"
+#include "mem/ruby/protocol/MessageSizeType.hh"
+#include "mem/ruby/slicc_interface/Message.hh"
+#include "sim/eventq.hh"
+#include "sim/serialize.hh"
+
+namespace gem5
+{
+
+namespace ruby
+{
+
+namespace garnet
+{
+
+class GarnetNetwork;
+
+// One message of a traffic trace. src and dest are NI ids, size is in
+// bytes (messages up to the control message size are control
+// messages, larger ones data messages). Records are sorted by tick.
+struct TrafficTraceRecord
+{
+    uint64_t tick;
+    uint32_t src;
+    uint32_t dest;
+    uint32_t vnet;
+    uint32_t size;
+};
+
+// Message injected by the NIs on behalf of a traffic trace. It has no
+// protocol consumer: the destination NI drops it after ejection.
+class TraceMessage : public Message
+{
+  public:
+    TraceMessage(Tick curTime, const NetDest &dest, MessageSizeType size)
+        : Message(curTime), m_destination(dest), m_size(size)
+    {}
+
+    MsgPtr clone() const { return std::make_shared<TraceMessage>(*this); }
+    void print(std::ostream& out) const;
+
+    const MessageSizeType &getMessageSize() const { return m_size; }
+    MessageSizeType &getMessageSize() { return m_size; }
+    const NetDest &getDestination() const { return m_destination; }
+    NetDest &getDestination() { return m_destination; }
+
+    bool functionalRead(Packet *pkt) { return false; }
+    bool functionalRead(Packet *pkt, WriteMask &mask) { return false; }
+    bool functionalWrite(Packet *pkt) { return false; }
+
+  private:
+    NetDest m_destination;
+    MessageSizeType m_size;
+};
+
+/*
+ * Replays a binary file of TrafficTraceRecords. The file is memory
+ * mapped and read sequentially: the kernel is asked to read ahead
+ * prefetch records beyond the current one and to drop the pages
+ * already replayed, so traces larger than the host memory can be
+ * streamed. Every record is handed to the network at its tick.
+ */
+class TrafficTrace : public Serializable
+{
+  public:
+    TrafficTrace(GarnetNetwork *net_ptr, const std::string &filename,
+                 uint32_t prefetch);
+    ~TrafficTrace();
+
+    // Schedules the next record (the first one, after a restore or
+    // after a drain)
+    void start();
+    // Stops the injection while the network drains
+    void pause();
+
+    // Position in the trace
+    void serialize(CheckpointOut &cp) const;
+    void unserialize(CheckpointIn &cp);
+
+  private:
+    void inject();
+    void advise(size_t record);
+
+    GarnetNetwork *m_net_ptr;
+    std::string m_filename;
+    const TrafficTraceRecord *m_records;
+    size_t m_num_records;
+    size_t m_next;
+    size_t m_mapped_bytes;
+    uint32_t m_prefetch;
+    // Records below this one have been advised
+    size_t m_advised;
+    EventFunctionWrapper m_event;
+};
+
+} // namespace garnet
+} // namespace ruby
+} // namespace gem5
+
+#endif // __MEM_RUBY_NETWORK_GARNET_0_TRAFFICTRACE_HH__
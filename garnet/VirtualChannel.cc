@@ -40,9 +40,11 @@ namespace ruby
 namespace garnet
 {
 
-VirtualChannel::VirtualChannel()
-  : inputBuffer(), m_vc_state(IDLE_, Tick(0)), m_output_port(-1),
-    m_enqueue_time(INFINITE_), m_output_vc(-1)
+VirtualChannel::VirtualChannel(int buffer_size)
+  : inputBuffer(buffer_size), m_vc_state(IDLE_, Tick(0)), m_output_port(-1),
+    m_enqueue_time(INFINITE_), m_output_vc(-1), m_wireless_out(-1),
+    m_escape_outport(-1), m_use_escape(false), m_token_wait(0),
+    m_token_wait_start(MaxTick)
 {
 }
 
@@ -54,6 +56,10 @@ VirtualChannel::set_idle(Tick curTime)
     m_enqueue_time = Tick(INFINITE_);
     m_output_port = -1;
     m_output_vc = -1;
+    m_escape_outport = -1;
+    m_use_escape = false;
+    m_token_wait = 0;
+    m_token_wait_start = MaxTick;
 }
 
 void
@@ -49,7 +49,7 @@ namespace garnet
 class VirtualChannel
 {
   public:
-    VirtualChannel();
+    VirtualChannel(int buffer_size = INFINITE_);
     ~VirtualChannel() = default;
 
     bool need_stage(flit_stage stage, Tick time);
@@ -61,6 +61,18 @@ class VirtualChannel
     inline int get_outv_wireless()                  { return m_wireless_out; }
     void set_out_wireless(int outport)           { m_wireless_out = outport; };
     inline int get_outport()                  { return m_output_port; }
+    // XY outport of the escape path, and whether the packet takes it
+    void set_escape_outport(int outport)    { m_escape_outport = outport; }
+    inline int get_escape_outport()         { return m_escape_outport; }
+    void set_use_escape(bool use_escape)    { m_use_escape = use_escape; }
+    inline bool get_use_escape()            { return m_use_escape; }
+
+    // Time spent waiting for the wireless token, and since when
+    // (MaxTick if not waiting)
+    inline Tick get_token_wait()            { return m_token_wait; }
+    inline Tick get_token_wait_start()      { return m_token_wait_start; }
+    void set_token_wait(Tick wait)          { m_token_wait = wait; }
+    void set_token_wait_start(Tick time)    { m_token_wait_start = time; }
 
     inline Tick get_enqueue_time()          { return m_enqueue_time; }
     inline void set_enqueue_time(Tick time) { m_enqueue_time = time; }
@@ -72,6 +84,9 @@ class VirtualChannel
         return inputBuffer.isReady(curTime);
     }
 
+    inline bool isEmpty()                   { return inputBuffer.isEmpty(); }
+    inline int get_size() const             { return inputBuffer.getSize(); }
+
     inline void
     insertFlit(flit *t_flit)
     {
@@ -107,6 +122,10 @@ class VirtualChannel
     Tick m_enqueue_time;
     int m_output_vc;
     int m_wireless_out;
+    int m_escape_outport;
+    bool m_use_escape;
+    Tick m_token_wait;
+    Tick m_token_wait_start;
 };
 
 } // namespace garnet
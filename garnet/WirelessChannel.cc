@@ -0,0 +1,462 @@
+/*
+ * Copyright (c) 2024 The gem5_garnet_wireless authors
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+#include "mem/ruby/network/garnet/WirelessChannel.hh"
+
+#include <algorithm>
+
+#include "base/trace.hh"
+#include "debug/RubyNetwork.hh"
+#include "mem/ruby/network/garnet/Credit.hh"
+#include "mem/ruby/network/garnet/CreditLink.hh"
+#include "mem/ruby/network/garnet/GarnetNetwork.hh"
+#include "mem/ruby/network/garnet/NetworkLink.hh"
+#include "mem/ruby/network/garnet/Router.hh"
+
+namespace gem5
+{
+
+namespace ruby
+{
+
+namespace garnet
+{
+
+WirelessChannel::WirelessChannel(const Params &p)
+    : ClockedObject(p), Consumer(this), m_id(p.channel_id),
+      m_rx_port_per_source(p.rx_port_per_source), m_net_ptr(nullptr),
+      m_rx_links(p.rx_links),
+      m_rx_credit_links(p.rx_credit_links), m_round_robin_tx(0),
+      m_token(this, name() + ".token")
+{
+    for (auto *router : p.hybrid_routers) {
+        m_routers.push_back(router);
+    }
+
+    int num_rx_ports = m_rx_port_per_source ?
+        m_routers.size() * (m_routers.size() - 1) : m_routers.size();
+    fatal_if(m_rx_links.size() != num_rx_ports ||
+             m_rx_credit_links.size() != num_rx_ports,
+             "%s needs one receive link and one credit link per "
+             "receive port (%d)\n", name(), num_rx_ports);
+
+    m_tx_queues.resize(m_routers.size(), nullptr);
+    m_rx_queues.resize(num_rx_ports);
+}
+
+int
+WirelessChannel::getRxPort(int src_router, int dest_router) const
+{
+    int rx = getTransceiverIdx(dest_router);
+    assert(rx != -1);
+    if (!m_rx_port_per_source)
+        return rx;
+
+    int tx = getTransceiverIdx(src_router);
+    assert(tx != -1 && tx != rx);
+    return rx * (m_routers.size() - 1) + (tx < rx ? tx : tx - 1);
+}
+
+/*
+ * Called by GarnetNetwork::init() before the hybrid routers get their
+ * wireless ports. The channel is the source of every receive link and
+ * the consumer of every credit link coming back from the receivers.
+ */
+void
+WirelessChannel::init_net_ptr(GarnetNetwork *net_ptr)
+{
+    m_net_ptr = net_ptr;
+    m_router_idx.assign(net_ptr->getNumRouters(), -1);
+
+    for (int i = 0; i < m_routers.size(); i++) {
+        Router *router = m_routers[i];
+        fatal_if(m_router_idx[router->get_id()] != -1,
+                 "Router %d is attached twice to %s\n", router->get_id(),
+                 name());
+        m_router_idx[router->get_id()] = i;
+    }
+
+    for (int port = 0; port < m_rx_links.size(); port++) {
+        Router *router = m_routers[getRxPortReceiver(port)];
+        int vc_per_vnet = router->get_vc_per_vnet();
+        m_rx_vc_per_vnet.push_back(vc_per_vnet);
+        m_rx_vc_state.emplace_back();
+        m_rx_vc_state[port].reserve(router->get_num_vcs());
+        for (int vc = 0; vc < router->get_num_vcs(); vc++) {
+            m_rx_vc_state[port].emplace_back(vc, net_ptr, vc_per_vnet,
+                                             router, WIRELESS_IN_PORT_);
+        }
+
+        m_rx_links[port]->setSourceQueue(&m_rx_queues[port], this);
+        m_rx_credit_links[port]->setLinkConsumer(this);
+    }
+
+    std::vector<int> holders;
+    for (auto *router : m_routers) {
+        holders.push_back(router->get_id());
+    }
+    m_token.init(holders, net_ptr);
+}
+
+void
+WirelessChannel::startup()
+{
+    m_token.startup();
+}
+
+void
+WirelessChannel::serialize(CheckpointOut &cp) const
+{
+    m_token.serializeSection(cp, "token");
+}
+
+void
+WirelessChannel::unserialize(CheckpointIn &cp)
+{
+    m_token.unserializeSection(cp, "token");
+}
+
+void
+WirelessChannel::addTransmitter(int router_id, flitBuffer *tx_queue)
+{
+    int idx = getTransceiverIdx(router_id);
+    fatal_if(idx == -1, "Router %d is not attached to %s\n", router_id,
+             name());
+    m_tx_queues[idx] = tx_queue;
+}
+
+/*
+ * The wakeup function of the WirelessChannel first returns the credits
+ * sent by the receivers to the shared pool. It then takes one flit off
+ * the medium (one flit per cycle) and hands it to the receive link of
+ * the addressed hybrid router only.
+ */
+void
+WirelessChannel::wakeup()
+{
+    assert(curTick() == clockEdge());
+
+    for (int i = 0; i < m_rx_credit_links.size(); i++) {
+        CreditLink *credit_link = m_rx_credit_links[i];
+        while (credit_link->isReady(curTick())) {
+            Credit *t_credit = (Credit *) credit_link->consumeLink();
+            int vc = t_credit->get_vc();
+            OutVcState &vc_state = m_rx_vc_state[i][vc];
+            assert(vc_state.isInState(ACTIVE_, curTick()));
+            vc_state.increment_credit(t_credit->get_count());
+            if (t_credit->is_free_signal()) {
+                // Every flit of the packet has left the receiver VC
+                // by the time it is freed, whoever transmitted it
+                assert(vc_state.get_credit_count() ==
+                       vc_state.get_max_credit_count());
+                vc_state.setState(IDLE_, curTick());
+            }
+            delete t_credit;
+        }
+    }
+
+    int num_tx = m_tx_queues.size();
+    for (int iter = 0; iter < num_tx; iter++) {
+        int tx = (m_round_robin_tx + iter) % num_tx;
+        flitBuffer *tx_queue = m_tx_queues[tx];
+        if (tx_queue == nullptr || !tx_queue->isReady(curTick()))
+            continue;
+
+        flit *t_flit = tx_queue->getTopFlit();
+        m_flits_transmitted++;
+
+        if (t_flit->get_dest_wireless() == WIRELESS_MULTICAST_) {
+            deliverForks(t_flit, tx);
+        } else {
+            int port = getRxPort(m_routers[tx]->get_id(),
+                                 t_flit->get_dest_wireless());
+
+            DPRINTF(RubyNetwork, "%s: Router %d transmitting to Router %d "
+                    "flit:%s\n", name(), m_routers[tx]->get_id(),
+                    t_flit->get_dest_wireless(), *t_flit);
+
+            m_rx_queues[port].insert(t_flit);
+            m_rx_links[port]->scheduleEventAbsolute(clockEdge());
+            m_filtered_receptions += num_tx - 2;
+        }
+
+        m_round_robin_tx = tx + 1;
+        if (m_round_robin_tx >= num_tx)
+            m_round_robin_tx = 0;
+        break;
+    }
+
+    for (auto *tx_queue : m_tx_queues) {
+        if (tx_queue != nullptr && !tx_queue->isEmpty()) {
+            scheduleEvent(Cycles(1));
+            break;
+        }
+    }
+}
+
+/*
+ * Hands one unicast copy of a multicast flit to the receive link of the
+ * hybrid router serving each of its destinations. The copies take on
+ * the wired route to their destination from there.
+ */
+void
+WirelessChannel::deliverForks(flit *t_flit, int tx)
+{
+    fatal_if(t_flit->get_type() != HEAD_TAIL_,
+             "%s: wireless multicast only supports single-flit packets "
+             "(is there a SerDes on the path?)\n", name());
+
+    std::vector<bool> received(m_routers.size(), false);
+    for (auto &fork : t_flit->get_wireless_forks()) {
+        int rx = getTransceiverIdx(fork.rx_router);
+        int port = getRxPort(m_routers[tx]->get_id(), fork.rx_router);
+        assert(fork.vc != -1);
+
+        fork.route.hops_traversed = t_flit->get_hops();
+        PacketInfoPtr packet =
+            std::make_shared<PacketInfo>(fork.route, fork.msg_ptr);
+        packet->path = t_flit->get_path();
+        flit *fork_flit = new flit(t_flit->getPacketID(), 0, fork.vc,
+            t_flit->get_vnet(), packet, 1, t_flit->msgSize, t_flit->m_width,
+            curTick());
+        fork_flit->set_enqueue_time(t_flit->get_enqueue_time());
+        fork_flit->set_src_delay(t_flit->get_src_delay());
+        fork_flit->set_dest_wireless(fork.rx_router);
+
+        DPRINTF(RubyNetwork, "%s: Router %d multicasting to Router %d "
+                "flit:%s\n", name(), m_routers[tx]->get_id(),
+                fork.rx_router, *fork_flit);
+
+        m_rx_queues[port].insert(fork_flit);
+        m_rx_links[port]->scheduleEventAbsolute(clockEdge());
+        received[rx] = true;
+        m_multicast_forks++;
+    }
+
+    m_multicast_flits++;
+    m_filtered_receptions += std::count(received.begin(), received.end(),
+                                        false) - 1;
+    delete t_flit;
+}
+
+bool
+WirelessChannel::has_free_fork_vcs(int src_router, flit *t_flit)
+{
+    int vnet = t_flit->get_vnet();
+
+    // VCs needed at each receive port
+    std::vector<int> needed(m_rx_links.size(), 0);
+    for (auto &fork : t_flit->get_wireless_forks()) {
+        needed[getRxPort(src_router, fork.rx_router)]++;
+    }
+
+    for (int port = 0; port < m_rx_links.size(); port++) {
+        if (needed[port] == 0)
+            continue;
+
+        int vc_base = vnet * m_rx_vc_per_vnet[port];
+        for (int vc = vc_base; vc < vc_base + m_rx_vc_per_vnet[port] &&
+             needed[port] > 0; vc++) {
+            if (m_rx_vc_state[port][vc].isInState(IDLE_, curTick()))
+                needed[port]--;
+        }
+        if (needed[port] > 0)
+            return false;
+    }
+
+    return true;
+}
+
+/*
+ * Reserves a VC for every destination of a multicast flit and takes
+ * the credit of its single flit. Returns the VC of the first copy (the
+ * multicast flit itself is not buffered at any receiver).
+ */
+int
+WirelessChannel::select_fork_vcs(int src_router, flit *t_flit)
+{
+    for (auto &fork : t_flit->get_wireless_forks()) {
+        fork.vc = select_free_vc(src_router, fork.rx_router,
+                                 t_flit->get_vnet());
+        assert(fork.vc != -1);
+        m_rx_vc_state[getRxPort(src_router, fork.rx_router)][fork.vc].
+            decrement_credit();
+    }
+
+    return t_flit->get_wireless_forks().front().vc;
+}
+
+bool
+WirelessChannel::has_free_vc(int src_router, int dest_router, int vnet)
+{
+    int port = getRxPort(src_router, dest_router);
+
+    // The escape VCs of the receivers stay unused: wireless packets
+    // are adaptive and must not enter the escape path at the receiver
+    int vc_base = vnet * m_rx_vc_per_vnet[port];
+    int vc_end = vc_base + m_rx_vc_per_vnet[port];
+    for (int vc = vc_base + m_net_ptr->getEscapeVcs(); vc < vc_end; vc++) {
+        if (m_rx_vc_state[port][vc].isInState(IDLE_, curTick()))
+            return true;
+    }
+
+    return false;
+}
+
+int
+WirelessChannel::select_free_vc(int src_router, int dest_router, int vnet)
+{
+    int port = getRxPort(src_router, dest_router);
+
+    int vc_base = vnet * m_rx_vc_per_vnet[port];
+    int vc_end = vc_base + m_rx_vc_per_vnet[port];
+    for (int vc = vc_base + m_net_ptr->getEscapeVcs(); vc < vc_end; vc++) {
+        if (m_rx_vc_state[port][vc].isInState(IDLE_, curTick())) {
+            m_rx_vc_state[port][vc].setState(ACTIVE_, curTick());
+            return vc;
+        }
+    }
+
+    return -1;
+}
+
+bool
+WirelessChannel::has_credit(int src_router, int dest_router, int vc)
+{
+    int port = getRxPort(src_router, dest_router);
+    assert(m_rx_vc_state[port][vc].isInState(ACTIVE_, curTick()));
+    return m_rx_vc_state[port][vc].has_credit();
+}
+
+void
+WirelessChannel::decrement_credit(int src_router, int dest_router, int vc)
+{
+    // The copies of a multicast flit took theirs in select_fork_vcs()
+    if (dest_router == WIRELESS_MULTICAST_)
+        return;
+
+    int port = getRxPort(src_router, dest_router);
+    m_rx_vc_state[port][vc].decrement_credit();
+}
+
+int
+WirelessChannel::get_congestion(int src_router, int dest_router, int vnet)
+{
+    int port = getRxPort(src_router, dest_router);
+
+    int occupancy = 0;
+    int vc_base = vnet * m_rx_vc_per_vnet[port];
+    for (int vc = vc_base; vc < vc_base + m_rx_vc_per_vnet[port]; vc++) {
+        occupancy += m_rx_vc_state[port][vc].get_max_credit_count() -
+                     m_rx_vc_state[port][vc].get_credit_count();
+    }
+
+    return occupancy;
+}
+
+int
+WirelessChannel::get_free_credits(int src_router)
+{
+    int credits = 0;
+    for (auto *router : m_routers) {
+        if (router->get_id() == src_router)
+            continue;
+        int port = getRxPort(src_router, router->get_id());
+        for (auto &vc_state : m_rx_vc_state[port])
+            credits += vc_state.get_credit_count();
+    }
+    return credits;
+}
+
+bool
+WirelessChannel::functionalRead(Packet *pkt, WriteMask &mask)
+{
+    bool read = false;
+    for (auto &rx_queue : m_rx_queues) {
+        if (rx_queue.functionalRead(pkt, mask))
+            read = true;
+    }
+    return read;
+}
+
+uint32_t
+WirelessChannel::functionalWrite(Packet *pkt)
+{
+    uint32_t num_functional_writes = 0;
+    for (auto &rx_queue : m_rx_queues) {
+        num_functional_writes += rx_queue.functionalWrite(pkt);
+    }
+    return num_functional_writes;
+}
+
+// The medium carries at most one flit per cycle
+void
+WirelessChannel::collateStats(double time_delta)
+{
+    m_utilization = m_flits_transmitted.value() / time_delta;
+}
+
+void
+WirelessChannel::regStats()
+{
+    ClockedObject::regStats();
+
+    m_flits_transmitted
+        .name(name() + ".flits_transmitted")
+        .flags(statistics::nozero)
+    ;
+
+    // Every transmission occupies the medium of all the transceivers.
+    // Copies heard and dropped by the non-addressed receivers are
+    // counted here instead of being simulated.
+    // Fraction of the cycles the medium carried a flit
+    m_utilization
+        .name(name() + ".utilization")
+        .flags(statistics::nozero)
+    ;
+
+    m_filtered_receptions
+        .name(name() + ".filtered_receptions")
+        .flags(statistics::nozero)
+    ;
+
+    m_multicast_flits
+        .name(name() + ".multicast_flits")
+        .flags(statistics::nozero)
+    ;
+
+    m_multicast_forks
+        .name(name() + ".multicast_forks")
+        .flags(statistics::nozero)
+    ;
+}
+
+} // namespace garnet
+} // namespace ruby
+} // namespace gem5
@@ -0,0 +1,196 @@
+/*
+ * Copyright (c) 2024 The gem5_garnet_wireless authors
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+#ifndef __MEM_RUBY_NETWORK_GARNET_0_WIRELESSCHANNEL_HH__
+#define __MEM_RUBY_NETWORK_GARNET_0_WIRELESSCHANNEL_HH__
+
+#include <iostream>
+#include <vector>
+
+#include "mem/ruby/common/Consumer.hh"
+#include "mem/ruby/network/garnet/CommonTypes.hh"
+#include "mem/ruby/network/garnet/OutVcState.hh"
+#include "mem/ruby/network/garnet/WirelessToken.hh"
+#include "mem/ruby/network/garnet/flitBuffer.hh"
+#include "params/WirelessChannel.hh"
+#include "sim/clocked_object.hh"
+
+namespace gem5
+{
+
+namespace ruby
+{
+
+namespace garnet
+{
+
+class GarnetNetwork;
+class NetworkLink;
+class CreditLink;
+class Router;
+
+/*
+ * A WirelessChannel models one shared wireless medium among a set of
+ * hybrid routers. Every hybrid router has one transmitter (its
+ * "Wireless_Out" OutputUnit) and one receiver (its "Wireless_In"
+ * InputUnit, fed by a receive link owned by the channel).
+ *
+ * A flit put on the medium is moved once, to the receive link of the
+ * addressed hybrid router only. The other transceivers would have heard
+ * the broadcast and filtered it out, which is accounted for in the stats
+ * but not simulated.
+ *
+ * Since all transmitters share the receiver's input VCs, the output VC
+ * and credit state of every receiver is kept here, in a single pool,
+ * rather than in the transmitting OutputUnits.
+ *
+ * With rx_port_per_source, every receiver instead has one receive port
+ * ("Wireless_In<src>" InputUnit) per transmitter on the channel, each
+ * with its own VCs, receive link and credit link.
+ *
+ * Every channel has its own token, so several channels (e.g., on
+ * different frequencies) carry flits in parallel.
+ *
+ * A wireless multicast flit (m_dest_wireless == WIRELESS_MULTICAST_)
+ * crosses the medium once; the channel then delivers one unicast copy
+ * per destination to the hybrid router serving it, in the VCs
+ * reserved by select_fork_vcs() during switch allocation.
+ */
+class WirelessChannel : public ClockedObject, public Consumer
+{
+  public:
+    typedef WirelessChannelParams Params;
+    WirelessChannel(const Params &p);
+    ~WirelessChannel() = default;
+
+    void init_net_ptr(GarnetNetwork *net_ptr);
+    void addTransmitter(int router_id, flitBuffer *tx_queue);
+    void startup();
+
+    // Token of a drained channel
+    void serialize(CheckpointOut &cp) const;
+    void unserialize(CheckpointIn &cp);
+
+    void wakeup();
+    void print(std::ostream& out) const {}
+
+    int get_id() const { return m_id; }
+    WirelessToken *getToken() { return &m_token; }
+    int getNumTransceivers() const { return m_routers.size(); }
+    Router *getRouter(int idx) { return m_routers[idx]; }
+
+    // Receive ports, indexed by receiver (and transmitter if per source)
+    int getNumRxPorts() const { return m_rx_links.size(); }
+    NetworkLink *getRxLink(int port) { return m_rx_links[port]; }
+    CreditLink *getRxCreditLink(int port) { return m_rx_credit_links[port]; }
+    // Receiving transceiver of a port
+    int
+    getRxPortReceiver(int port) const
+    {
+        return m_rx_port_per_source ? port / (m_routers.size() - 1) : port;
+    }
+    // Transmitting transceiver of a port, -1 if shared by all of them
+    int
+    getRxPortSource(int port) const
+    {
+        if (!m_rx_port_per_source)
+            return -1;
+        int rx = getRxPortReceiver(port);
+        int tx = port % (m_routers.size() - 1);
+        return tx < rx ? tx : tx + 1;
+    }
+    // Receive port of dest_router for flits sent by src_router
+    int getRxPort(int src_router, int dest_router) const;
+
+    // Index of the transceiver of this router, -1 if not on the channel
+    int
+    getTransceiverIdx(int router_id) const
+    {
+        if (router_id < 0 || router_id >= m_router_idx.size())
+            return -1;
+        return m_router_idx[router_id];
+    }
+
+    // VC / credit pool of the receive port of dest_router
+    // used by src_router
+    bool has_free_vc(int src_router, int dest_router, int vnet);
+    int select_free_vc(int src_router, int dest_router, int vnet);
+    bool has_credit(int src_router, int dest_router, int vc);
+    void decrement_credit(int src_router, int dest_router, int vc);
+    int get_congestion(int src_router, int dest_router, int vnet);
+    // Free buffers of all the receivers src_router sends to
+    int get_free_credits(int src_router);
+
+    // VCs of all the destinations of a multicast flit from src_router
+    bool has_free_fork_vcs(int src_router, flit *t_flit);
+    int select_fork_vcs(int src_router, flit *t_flit);
+
+    bool functionalRead(Packet *pkt, WriteMask &mask);
+    uint32_t functionalWrite(Packet *pkt);
+
+    void regStats();
+    void collateStats(double time_delta);
+
+  private:
+    void deliverForks(flit *t_flit, int tx);
+
+    const int m_id;
+    const bool m_rx_port_per_source;
+    GarnetNetwork *m_net_ptr;
+
+    // One entry per transceiver
+    std::vector<Router *> m_routers;
+    std::vector<flitBuffer *> m_tx_queues;
+
+    // One entry per receive port
+    std::vector<NetworkLink *> m_rx_links;
+    std::vector<CreditLink *> m_rx_credit_links;
+    std::vector<flitBuffer> m_rx_queues;
+    std::vector<int> m_rx_vc_per_vnet;
+    std::vector<std::vector<OutVcState>> m_rx_vc_state;
+
+    // transceiver idx by router id
+    std::vector<int> m_router_idx;
+    int m_round_robin_tx;
+
+    WirelessToken m_token;
+
+    // Statistical variables
+    statistics::Scalar m_flits_transmitted;
+    statistics::Scalar m_utilization;
+    statistics::Scalar m_filtered_receptions;
+    statistics::Scalar m_multicast_flits;
+    statistics::Scalar m_multicast_forks;
+};
+
+} // namespace garnet
+} // namespace ruby
+} // namespace gem5
+
+#endif // __MEM_RUBY_NETWORK_GARNET_0_WIRELESSCHANNEL_HH__
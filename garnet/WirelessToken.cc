@@ -0,0 +1,321 @@
+/*
+ * Copyright (c) 2024 The gem5_garnet_wireless authors
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+#include "mem/ruby/network/garnet/WirelessToken.hh"
+
+#include <algorithm>
+#include <cassert>
+
+#include "base/logging.hh"
+#include "base/trace.hh"
+#include "debug/GarnetToken.hh"
+#include "mem/ruby/network/garnet/GarnetNetwork.hh"
+#include "mem/ruby/network/garnet/Router.hh"
+
+namespace gem5
+{
+
+namespace ruby
+{
+
+namespace garnet
+{
+
+WirelessToken::WirelessToken(ClockedObject *owner, const std::string &name)
+    : m_owner(owner),
+      m_event([this]{ change(); }, name, false, Event::Debug_Enable_Pri),
+      m_token_idx(0), m_mode(enums::TOKEN_ROTATE),
+      m_hold(enums::HOLD_NONE), m_hold_flits(0), m_qos(false),
+      m_starvation_ticks(0), m_flits_sent(0),
+      m_mid_packet(false), m_pending(false), m_last_flit_time(0)
+{
+}
+
+void
+WirelessToken::init(const std::vector<int> &holders, GarnetNetwork *net_ptr)
+{
+    int num_routers = net_ptr->getNumRouters();
+
+    m_holders = holders;
+    m_mode = net_ptr->getTokenMode();
+    m_hold = net_ptr->getTokenHold();
+    m_hold_flits = net_ptr->getTokenHoldFlits();
+    m_qos = (net_ptr->getArbitration() == enums::ARB_QOS);
+    m_starvation_ticks =
+        m_owner->cyclesToTicks(Cycles(net_ptr->getQosStarvationCycles()));
+
+    m_holder_idx.assign(num_routers, -1);
+    m_routers.clear();
+    for (int i = 0; i < m_holders.size(); i++) {
+        int router_id = m_holders[i];
+        fatal_if(router_id < 0 || router_id >= num_routers,
+                 "Hybrid router %d does not exist\n", router_id);
+        m_holder_idx[router_id] = i;
+        m_routers.push_back(net_ptr->getRouter(router_id));
+    }
+    m_requests.assign(m_holders.size(), false);
+    m_priority_requests.assign(m_holders.size(), false);
+    m_request_time.assign(m_holders.size(), 0);
+}
+
+// In demand mode the token is only moved on request
+void
+WirelessToken::startup()
+{
+    if (m_holders.empty() || m_event.scheduled())
+        return;
+
+    if (m_mode == enums::TOKEN_ROTATE ||
+        std::find(m_requests.begin(), m_requests.end(), true) !=
+        m_requests.end()) {
+        m_owner->schedule(m_event, m_owner->nextCycle());
+    }
+}
+
+// Position and tenure of the token, and the pending requests. These
+// do not depend on the token mode, so a checkpoint may be restored
+// with another token policy.
+void
+WirelessToken::serialize(CheckpointOut &cp) const
+{
+    int num_holders = m_holders.size();
+    paramOut(cp, "num_holders", num_holders);
+    paramOut(cp, "token_id", m_token_idx);
+    paramOut(cp, "flits_sent", m_flits_sent);
+    paramOut(cp, "mid_packet", m_mid_packet);
+    paramOut(cp, "pending", m_pending);
+    paramOut(cp, "last_flit_time", m_last_flit_time);
+    arrayParamOut(cp, "requests", m_requests);
+    arrayParamOut(cp, "priority_requests", m_priority_requests);
+    arrayParamOut(cp, "request_time", m_request_time);
+}
+
+void
+WirelessToken::unserialize(CheckpointIn &cp)
+{
+    int num_holders;
+    paramIn(cp, "num_holders", num_holders);
+    fatal_if(num_holders != m_holders.size(), "%s: checkpoint has %d "
+             "token holders, the configuration %d\n", m_event.name(),
+             num_holders, m_holders.size());
+
+    paramIn(cp, "token_id", m_token_idx);
+    paramIn(cp, "flits_sent", m_flits_sent);
+    paramIn(cp, "mid_packet", m_mid_packet);
+    paramIn(cp, "pending", m_pending);
+    paramIn(cp, "last_flit_time", m_last_flit_time);
+    arrayParamIn(cp, "requests", m_requests);
+    arrayParamIn(cp, "priority_requests", m_priority_requests);
+    arrayParamIn(cp, "request_time", m_request_time);
+}
+
+int
+WirelessToken::get_holder() const
+{
+    assert(!m_holders.empty());
+    return m_holders[m_token_idx];
+}
+
+/*
+ * Moves the token. In rotate mode to the next holder, in demand mode
+ * to the next holder (round robin) with a pending request, or the one
+ * picked by qosPick(). The event is then only scheduled again while
+ * requests are pending.
+ */
+void
+WirelessToken::change()
+{
+    int num_holders = m_holders.size();
+    int prev_token_idx = m_token_idx;
+
+    if (held()) {
+        // The holder keeps transmitting, requests stay pending
+        m_owner->schedule(m_event, m_owner->nextCycle());
+        return;
+    }
+
+    if (m_mode == enums::TOKEN_ROTATE) {
+        m_token_idx = (m_token_idx + 1) % num_holders;
+        m_owner->schedule(m_event, m_owner->nextCycle());
+    } else if (m_qos) {
+        int idx = qosPick();
+        if (idx != -1)
+            m_token_idx = idx;
+    } else {
+        for (int i = 1; i <= num_holders; i++) {
+            int idx = (m_token_idx + i) % num_holders;
+            if (m_requests[idx]) {
+                m_token_idx = idx;
+                break;
+            }
+        }
+    }
+
+    // A requester does not poll for the token, it is woken up
+    // (this cycle) once it gets the token
+    if (m_requests[m_token_idx]) {
+        m_requests[m_token_idx] = false;
+        m_priority_requests[m_token_idx] = false;
+        m_routers[m_token_idx]->schedule_wakeup(Cycles(0));
+    }
+
+    if (m_mode == enums::TOKEN_DEMAND && !m_event.scheduled() &&
+        std::find(m_requests.begin(), m_requests.end(), true) !=
+        m_requests.end()) {
+        m_owner->schedule(m_event, m_owner->nextCycle());
+    }
+
+    if (m_token_idx != prev_token_idx) {
+        // New tenure
+        m_flits_sent = 0;
+        m_mid_packet = false;
+        m_pending = false;
+    }
+
+    DPRINTF(GarnetToken, "%s is with router %d\n", m_event.name(),
+            get_holder());
+}
+
+/*
+ * Called by a holder whose wireless outport has a flit waiting in SA
+ * while it does not hold the token. The request stays pending until
+ * the token reaches the holder, which is then woken up.
+ */
+void
+WirelessToken::request(int router_id, bool priority)
+{
+    int idx = m_holder_idx[router_id];
+    assert(idx != -1);
+    if (!m_requests[idx])
+        m_request_time[idx] = curTick();
+    m_requests[idx] = true;
+    if (priority)
+        m_priority_requests[idx] = true;
+
+    if (!m_event.scheduled()) {
+        m_owner->schedule(m_event, m_owner->nextCycle());
+    }
+}
+
+/*
+ * ARB_QOS grant: the first requester after the holder (round robin)
+ * of the highest class: starving requests, then control requests,
+ * then any request. -1 if there is no request.
+ */
+int
+WirelessToken::qosPick() const
+{
+    int num_holders = m_holders.size();
+    int best = -1;
+    int best_class = -1;
+    for (int i = 1; i <= num_holders; i++) {
+        int idx = (m_token_idx + i) % num_holders;
+        if (!m_requests[idx])
+            continue;
+        int req_class =
+            (curTick() - m_request_time[idx] >= m_starvation_ticks) ? 2 :
+            (m_priority_requests[idx] ? 1 : 0);
+        if (req_class > best_class) {
+            best = idx;
+            best_class = req_class;
+        }
+    }
+    return best;
+}
+
+/*
+ * Estimated number of cycles until router_id gets the token: its
+ * distance from the holder in rotate mode, the number of requesters
+ * served before it in demand mode.
+ */
+int
+WirelessToken::expectedWait(int router_id) const
+{
+    if (m_holders.empty() || m_holder_idx[router_id] == -1 ||
+        holds(router_id)) {
+        return 0;
+    }
+
+    int num_holders = m_holders.size();
+    int idx = m_holder_idx[router_id];
+
+    if (m_mode == enums::TOKEN_ROTATE)
+        return (idx - m_token_idx + num_holders) % num_holders;
+
+    int wait = 1;
+    for (int i = (m_token_idx + 1) % num_holders; i != idx;
+         i = (i + 1) % num_holders) {
+        if (m_requests[i])
+            wait++;
+    }
+    return wait;
+}
+
+/*
+ * Called by the holder for every flit it sends on the medium.
+ * pending tells if it still has packets for the medium after this flit.
+ */
+void
+WirelessToken::flitSent(int router_id, flit_type type, bool pending)
+{
+    assert(holds(router_id));
+
+    m_flits_sent++;
+    m_mid_packet = (type == HEAD_ || type == BODY_);
+    m_pending = pending;
+    m_last_flit_time = curTick();
+}
+
+// Whether the current holder keeps the token in the next cycle
+bool
+WirelessToken::held() const
+{
+    // Release early once the holder has nothing more to send, or
+    // sent no flit in the last cycle (e.g., its packet is blocked on
+    // the receiver VCs or took the escape path)
+    if (!m_pending ||
+        m_last_flit_time + m_owner->clockPeriod() < curTick()) {
+        return false;
+    }
+
+    switch (m_hold) {
+      case enums::HOLD_TAIL:
+        return m_mid_packet;
+      case enums::HOLD_FLITS:
+        return m_mid_packet && m_flits_sent < m_hold_flits;
+      case enums::HOLD_QUEUE:
+        return m_flits_sent < m_hold_flits;
+      default:
+        return false;
+    }
+}
+
+} // namespace garnet
+} // namespace ruby
+} // namespace gem5
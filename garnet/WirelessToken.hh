@@ -0,0 +1,141 @@
+/*
+ * Copyright (c) 2024 The gem5_garnet_wireless authors
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+#ifndef __MEM_RUBY_NETWORK_GARNET_0_WIRELESSTOKEN_HH__
+#define __MEM_RUBY_NETWORK_GARNET_0_WIRELESSTOKEN_HH__
+
+#include <string>
+#include <vector>
+
+#include "enums/SwitchArbitration.hh"
+#include "enums/WirelessTokenHold.hh"
+#include "enums/WirelessTokenMode.hh"
+#include "mem/ruby/network/garnet/CommonTypes.hh"
+#include "sim/clocked_object.hh"
+#include "sim/eventq.hh"
+#include "sim/serialize.hh"
+
+namespace gem5
+{
+
+namespace ruby
+{
+
+namespace garnet
+{
+
+class GarnetNetwork;
+class Router;
+
+/*
+ * A WirelessToken arbitrates the access of a set of hybrid routers to
+ * one wireless medium: only the holder may send flits on it.
+ *
+ * In TOKEN_ROTATE mode every holder gets a slot in turn, one cycle
+ * at a time. In TOKEN_DEMAND mode the token only goes to holders that
+ * requested it, and no event is scheduled while nobody requests it.
+ * With ARB_QOS arbitration, requests for control packets and requests
+ * pending for qos_starvation_cycles are served first (demand mode).
+ * The hold policy may keep the token with the current holder for
+ * several flits, as long as the holder sends a flit every cycle. A
+ * requesting router is not woken up again until the token reaches it.
+ *
+ * The token is driven by the clock of its owner (the network for
+ * point-to-point wireless links, or a WirelessChannel), which also
+ * checkpoints it as one of its sections.
+ */
+class WirelessToken : public Serializable
+{
+  public:
+    WirelessToken(ClockedObject *owner, const std::string &name);
+
+    void init(const std::vector<int> &holders, GarnetNetwork *net_ptr);
+    // Schedules the token, after init() and a checkpoint restore
+    void startup();
+
+    void serialize(CheckpointOut &cp) const;
+    void unserialize(CheckpointIn &cp);
+
+    int get_holder() const;
+    int getNumHolders() const { return m_holders.size(); }
+
+    bool
+    holds(int router_id) const
+    {
+        return !m_holders.empty() && get_holder() == router_id;
+    }
+
+    // priority: the request is for a control packet (ARB_QOS)
+    void request(int router_id, bool priority = false);
+
+    bool
+    requested(int router_id) const
+    {
+        return m_requests[m_holder_idx[router_id]];
+    }
+    void flitSent(int router_id, flit_type type, bool pending);
+    int expectedWait(int router_id) const;
+
+  private:
+    void change();
+    bool held() const;
+    int qosPick() const;
+
+    ClockedObject *m_owner;
+    EventFunctionWrapper m_event;
+
+    std::vector<int> m_holders;
+    std::vector<Router *> m_routers;
+    // m_holders idx by router id (-1 if not a holder)
+    std::vector<int> m_holder_idx;
+    // pending requests by m_holders idx
+    std::vector<bool> m_requests;
+    // ARB_QOS: control requests and time of the first pending request
+    std::vector<bool> m_priority_requests;
+    std::vector<Tick> m_request_time;
+    int m_token_idx;
+
+    enums::WirelessTokenMode m_mode;
+    enums::WirelessTokenHold m_hold;
+    uint32_t m_hold_flits;
+    bool m_qos;
+    Tick m_starvation_ticks;
+
+    // Current tenure of the holder
+    uint32_t m_flits_sent;
+    bool m_mid_packet;
+    bool m_pending;
+    Tick m_last_flit_time;
+};
+
+} // namespace garnet
+} // namespace ruby
+} // namespace gem5
+
+#endif // __MEM_RUBY_NETWORK_GARNET_0_WIRELESSTOKEN_HH__
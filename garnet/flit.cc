@@ -43,11 +43,11 @@ namespace garnet
 {
 
 // Constructor for the flit
-flit::flit(int packet_id, int id, int  vc, int vnet, RouteInfo route, int size,
-    MsgPtr msg_ptr, int MsgSize, uint32_t bWidth, Tick curTime)
+flit::flit(int packet_id, int id, int  vc, int vnet, PacketInfoPtr packet,
+    int size, int MsgSize, uint32_t bWidth, Tick curTime)
+    : m_packet(std::move(packet))
 {
     m_size = size;
-    m_msg_ptr = msg_ptr;
     m_enqueue_time = curTime;
     m_dequeue_time = curTime;
     m_time = curTime;
@@ -55,11 +55,15 @@ flit::flit(int packet_id, int id, int  vc, int vnet, RouteInfo route, int size,
     m_id = id;
     m_vnet = vnet;
     m_vc = vc;
-    m_route = route;
+    m_hops = m_packet ? m_packet->route.hops_traversed : 0;
     m_stage.first = I_;
     m_stage.second = curTime;
     m_width = bWidth;
     msgSize = MsgSize;
+    m_dest_wireless = -1;
+    m_crossed_wireless = false;
+    m_lookahead_outport = -1;
+    m_lookahead_dest_wireless = -1;
 
     if (size == 1) {
         m_type = HEAD_TAIL_;
@@ -83,10 +87,14 @@ flit::serialize(int ser_id, int parts, uint32_t bWidth)
     int new_size = (int)divCeil((float)msgSize, (float)bWidth);
     assert(new_id < new_size);
 
-    flit *fl = new flit(m_packet_id, new_id, m_vc, m_vnet, m_route,
-                    new_size, m_msg_ptr, msgSize, bWidth, m_time);
+    flit *fl = new flit(m_packet_id, new_id, m_vc, m_vnet, m_packet,
+                    new_size, msgSize, bWidth, m_time);
+    fl->m_hops = m_hops;
     fl->set_enqueue_time(m_enqueue_time);
     fl->set_src_delay(src_delay);
+    fl->set_dest_wireless(m_dest_wireless);
+    fl->set_lookahead(m_lookahead_outport, m_lookahead_dest_wireless);
+    fl->m_crossed_wireless = m_crossed_wireless;
     return fl;
 }
 
@@ -98,10 +106,14 @@ flit::deserialize(int des_id, int num_flits, uint32_t bWidth)
     int new_size = (int)divCeil((float)msgSize, (float)bWidth);
     assert(new_id < new_size);
 
-    flit *fl = new flit(m_packet_id, new_id, m_vc, m_vnet, m_route,
-                    new_size, m_msg_ptr, msgSize, bWidth, m_time);
+    flit *fl = new flit(m_packet_id, new_id, m_vc, m_vnet, m_packet,
+                    new_size, msgSize, bWidth, m_time);
+    fl->m_hops = m_hops;
     fl->set_enqueue_time(m_enqueue_time);
     fl->set_src_delay(src_delay);
+    fl->set_dest_wireless(m_dest_wireless);
+    fl->set_lookahead(m_lookahead_outport, m_lookahead_dest_wireless);
+    fl->m_crossed_wireless = m_crossed_wireless;
     return fl;
 }
 
@@ -116,10 +128,12 @@ flit::print(std::ostream& out) const
     out << "Size=" << m_size << " ";
     out << "Vnet=" << m_vnet << " ";
     out << "VC=" << m_vc << " ";
-    out << "Src NI=" << m_route.src_ni << " ";
-    out << "Src Router=" << m_route.src_router << " ";
-    out << "Dest NI=" << m_route.dest_ni << " ";
-    out << "Dest Router=" << m_route.dest_router << " ";
+    if (m_packet) {
+        out << "Src NI=" << m_packet->route.src_ni << " ";
+        out << "Src Router=" << m_packet->route.src_router << " ";
+        out << "Dest NI=" << m_packet->route.dest_ni << " ";
+        out << "Dest Router=" << m_packet->route.dest_router << " ";
+    }
     out << "Set Time=" << m_time << " ";
     out << "Width=" << m_width<< " ";
     out << "]";
@@ -128,14 +142,14 @@ flit::print(std::ostream& out) const
 bool
 flit::functionalRead(Packet *pkt, WriteMask &mask)
 {
-    Message *msg = m_msg_ptr.get();
+    Message *msg = m_packet->msg_ptr.get();
     return msg->functionalRead(pkt, mask);
 }
 
 bool
 flit::functionalWrite(Packet *pkt)
 {
-    Message *msg = m_msg_ptr.get();
+    Message *msg = m_packet->msg_ptr.get();
     return msg->functionalWrite(pkt);
 }
 
@@ -31,11 +31,16 @@
 #ifndef __MEM_RUBY_NETWORK_GARNET_0_FLIT_HH__
 #define __MEM_RUBY_NETWORK_GARNET_0_FLIT_HH__
 
+#include <algorithm>
 #include <cassert>
+#include <cstdint>
 #include <iostream>
+#include <memory>
+#include <vector>
 
 #include "base/types.hh"
 #include "mem/ruby/network/garnet/CommonTypes.hh"
+#include "mem/ruby/network/garnet/flitPool.hh"
 #include "mem/ruby/slicc_interface/Message.hh"
 
 namespace gem5
@@ -47,15 +52,82 @@ namespace ruby
 namespace garnet
 {
 
+// One destination of a wireless multicast packet. The channel turns
+// it into a unicast flit at the hybrid router serving the destination.
+struct WirelessFork
+{
+    int rx_router;
+    int vc;
+    RouteInfo route;
+    MsgPtr msg_ptr;
+};
+
+// Routers traversed by a packet, recorded by its tail flit when the
+// path is traced (GarnetWireless debug flag or path_stats). Longer
+// paths are counted but only their first MAX_ROUTERS are kept.
+struct PacketPath
+{
+    static const int MAX_ROUTERS = 32;
+
+    void
+    record(int router_id)
+    {
+        if (length < MAX_ROUTERS)
+            routers[length] = router_id;
+        length++;
+    }
+
+    int recorded() const { return std::min(length, MAX_ROUTERS); }
+
+    int length = 0;
+    uint16_t routers[MAX_ROUTERS];
+};
+
+// Per-packet state shared by all the flits of a packet and by the
+// fragments of a SerDes bridge. Only the per-flit header (type, vc,
+// stage, times, outport) is copied when flits are made or moved.
+struct PacketInfo
+{
+    PacketInfo(const RouteInfo &route, const MsgPtr &msg_ptr)
+        : route(route), msg_ptr(msg_ptr)
+    {}
+
+    RouteInfo route;
+    MsgPtr msg_ptr;
+    PacketPath path;
+    // Only set for WIRELESS_MULTICAST_ packets
+    std::vector<WirelessFork> wireless_forks;
+};
+
+typedef std::shared_ptr<PacketInfo> PacketInfoPtr;
+
 class flit
 {
   public:
     flit() {}
-    flit(int packet_id, int id, int vc, int vnet, RouteInfo route, int size,
-         MsgPtr msg_ptr, int MsgSize, uint32_t bWidth, Tick curTime);
+    flit(int packet_id, int id, int vc, int vnet, PacketInfoPtr packet,
+         int size, int MsgSize, uint32_t bWidth, Tick curTime);
 
     virtual ~flit(){};
-    std::vector<int>path;
+
+    // Flits are allocated from a free list, derived classes of another
+    // size (e.g., Credit) provide their own pool or use the heap
+    static void *
+    operator new(std::size_t size)
+    {
+        if (size == sizeof(flit))
+            return flitPool<sizeof(flit)>::allocate();
+        return ::operator new(size);
+    }
+
+    static void
+    operator delete(void *ptr, std::size_t size)
+    {
+        if (size == sizeof(flit))
+            flitPool<sizeof(flit)>::release(ptr);
+        else
+            ::operator delete(ptr);
+    }
 
     int get_outport() {return m_outport; }
     int get_size() { return m_size; }
@@ -66,22 +138,44 @@ class flit
     Tick get_time() { return m_time; }
     int get_vnet() { return m_vnet; }
     int get_vc() { return m_vc; }
-    RouteInfo get_route() { return m_route; }
-    MsgPtr& get_msg_ptr() { return m_msg_ptr; }
+    // The packet descriptor is shared: route, message and path are
+    // the same for every flit of the packet
+    const PacketInfoPtr &get_packet_info() { return m_packet; }
+    const RouteInfo &get_route() { return m_packet->route; }
+    MsgPtr& get_msg_ptr() { return m_packet->msg_ptr; }
+    PacketPath& get_path() { return m_packet->path; }
+    // Routers traversed by this flit (-1 before the first router)
+    int get_hops() { return m_hops; }
     flit_type get_type() { return m_type; }
     std::pair<flit_stage, Tick> get_stage() { return m_stage; }
     Tick get_src_delay() { return src_delay; }
     int get_dest_wireless() {return m_dest_wireless;}
     void set_dest_wireless(int dest_wireless) {m_dest_wireless = dest_wireless;}
+    std::vector<WirelessFork>&
+    get_wireless_forks()
+    {
+        return m_packet->wireless_forks;
+    }
+    // The flit took a wireless hop on its way
+    bool crossed_wireless() { return m_crossed_wireless; }
+    void set_crossed_wireless() { m_crossed_wireless = true; }
+    // Route computed by the previous router (lookahead routing)
+    int get_lookahead_outport() { return m_lookahead_outport; }
+    int get_lookahead_dest_wireless() { return m_lookahead_dest_wireless; }
+    void
+    set_lookahead(int outport, int dest_wireless)
+    {
+        m_lookahead_outport = outport;
+        m_lookahead_dest_wireless = dest_wireless;
+    }
     void set_outport(int port) { m_outport = port; }
     void set_time(Tick time) { m_time = time; }
     void set_vc(int vc) { m_vc = vc; }
-    void set_route(RouteInfo route) { m_route = route; }
     void set_src_delay(Tick delay) { src_delay = delay; }
     void set_dequeue_time(Tick time) { m_dequeue_time = time; }
     void set_enqueue_time(Tick time) { m_enqueue_time = time; }
 
-    void increment_hops() { m_route.hops_traversed++; }
+    void increment_hops() { m_hops++; }
     virtual void print(std::ostream& out) const;
 
     bool
@@ -120,15 +214,19 @@ class flit
   protected:
     int m_packet_id;
     int m_dest_wireless;
+    bool m_crossed_wireless;
+    int m_lookahead_outport;
+    int m_lookahead_dest_wireless;
     int m_id;
     int m_vnet;
     int m_vc;
-    RouteInfo m_route;
+    // Null for credits
+    PacketInfoPtr m_packet;
+    int m_hops;
     int m_size;
     Tick m_enqueue_time, m_dequeue_time;
     Tick m_time;
     flit_type m_type;
-    MsgPtr m_msg_ptr;
     int m_outport;
     Tick src_delay;
     std::pair<flit_stage, Tick> m_stage;
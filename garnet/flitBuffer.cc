@@ -41,25 +41,81 @@ namespace garnet
 {
 
 flitBuffer::flitBuffer()
+    : m_slots(m_inline_slots), m_capacity(InlineCapacity), m_head(0),
+      m_size(0), max_size(INFINITE_)
 {
-    max_size = INFINITE_;
 }
 
 flitBuffer::flitBuffer(int maximum_size)
+    : flitBuffer()
 {
-    max_size = maximum_size;
+    setMaxSize(maximum_size);
+}
+
+flitBuffer::flitBuffer(const flitBuffer &other)
+    : flitBuffer()
+{
+    *this = other;
+}
+
+flitBuffer &
+flitBuffer::operator=(const flitBuffer &other)
+{
+    if (this == &other)
+        return *this;
+
+    m_head = 0;
+    m_size = 0;
+    max_size = other.max_size;
+    if (other.m_capacity > m_capacity)
+        reserve(other.m_capacity);
+    for (int i = 0; i < other.m_size; i++) {
+        m_slots[i] = other.m_slots[(other.m_head + i) &
+                                   (other.m_capacity - 1)];
+    }
+    m_size = other.m_size;
+    return *this;
+}
+
+flitBuffer::~flitBuffer()
+{
+    if (m_slots != m_inline_slots)
+        delete [] m_slots;
+}
+
+// Grow the storage to at least capacity flits, keeping the FIFO order
+void
+flitBuffer::reserve(int capacity)
+{
+    if (capacity <= m_capacity)
+        return;
+
+    int new_capacity = m_capacity;
+    while (new_capacity < capacity)
+        new_capacity *= 2;
+
+    flit **new_slots = new flit *[new_capacity];
+    for (int i = 0; i < m_size; i++) {
+        new_slots[i] = at(i);
+    }
+
+    if (m_slots != m_inline_slots)
+        delete [] m_slots;
+    m_slots = new_slots;
+    m_capacity = new_capacity;
+    m_head = 0;
 }
 
 bool
 flitBuffer::isEmpty()
 {
-    return (m_buffer.size() == 0);
+    return (m_size == 0);
 }
 
 bool
 flitBuffer::isReady(Tick curTime)
 {
-    if (m_buffer.size() != 0 ) {
+    if (m_size != 0 ) {
         flit *t_flit = peekTopFlit();
         if (t_flit->get_time() <= curTime)
             return true;
@@ -70,27 +126,31 @@ flitBuffer::isReady(Tick curTime)
 void
 flitBuffer::print(std::ostream& out) const
 {
-    out << "[flitBuffer: " << m_buffer.size() << "] " << std::endl;
+    out << "[flitBuffer: " << m_size << "] " << std::endl;
 }
 
 bool
 flitBuffer::isFull()
 {
-    return (m_buffer.size() >= max_size);
+    return (m_size >= max_size);
 }
 
 void
 flitBuffer::setMaxSize(int maximum)
 {
     max_size = maximum;
+
+    // Unbounded buffers grow on demand
+    if (maximum != INFINITE_)
+        reserve(maximum);
 }
 
 bool
 flitBuffer::functionalRead(Packet *pkt, WriteMask &mask)
 {
     bool read = false;
-    for (unsigned int i = 0; i < m_buffer.size(); ++i) {
-        if (m_buffer[i]->functionalRead(pkt, mask)) {
+    for (int i = 0; i < m_size; ++i) {
+        if (at(i)->functionalRead(pkt, mask)) {
             read = true;
         }
     }
@@ -103,8 +163,8 @@ flitBuffer::functionalWrite(Packet *pkt)
 {
     uint32_t num_functional_writes = 0;
 
-    for (unsigned int i = 0; i < m_buffer.size(); ++i) {
-        if (m_buffer[i]->functionalWrite(pkt)) {
+    for (int i = 0; i < m_size; ++i) {
+        if (at(i)->functionalWrite(pkt)) {
             num_functional_writes++;
         }
     }
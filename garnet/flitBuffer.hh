@@ -32,6 +32,7 @@
 #define __MEM_RUBY_NETWORK_GARNET_0_FLITBUFFER_HH__
 
 #include <algorithm>
+#include <cassert>
 #include <iostream>
 #include <vector>
 
@@ -47,44 +48,84 @@ namespace ruby
 namespace garnet
 {
 
+/*
+ * FIFO of flits, implemented as a ring buffer.
+ * Buffers of up to InlineCapacity flits (VCs, switch and output
+ * buffers) need no heap storage. The capacity is reserved from the
+ * maximum size if it is known, and grows (by powers of 2) if more flits
+ * are inserted, so unbounded buffers (e.g., NI queues) keep working.
+ */
 class flitBuffer
 {
   public:
     flitBuffer();
     flitBuffer(int maximum_size);
+    flitBuffer(const flitBuffer &other);
+    flitBuffer &operator=(const flitBuffer &other);
+    ~flitBuffer();
 
     bool isReady(Tick curTime);
     bool isEmpty();
     void print(std::ostream& out) const;
     bool isFull();
     void setMaxSize(int maximum);
-    int getSize() const { return m_buffer.size(); }
+    int getSize() const { return m_size; }
 
     flit *
     getTopFlit()
     {
-        flit *f = m_buffer.front();
-        m_buffer.pop_front();
+        assert(m_size > 0);
+        flit *f = m_slots[m_head];
+        m_head = (m_head + 1) & (m_capacity - 1);
+        m_size--;
         return f;
     }
 
     flit *
     peekTopFlit()
     {
-        return m_buffer.front();
+        assert(m_size > 0);
+        return m_slots[m_head];
+    }
+
+    // Last inserted flit
+    flit *
+    peekBackFlit()
+    {
+        assert(m_size > 0);
+        return at(m_size - 1);
     }
 
     void
     insert(flit *flt)
     {
-        m_buffer.push_back(flt);
+        if (m_size == m_capacity)
+            reserve(2 * m_capacity);
+        m_slots[(m_head + m_size) & (m_capacity - 1)] = flt;
+        m_size++;
     }
 
     bool functionalRead(Packet *pkt, WriteMask &mask);
     uint32_t functionalWrite(Packet *pkt);
 
   private:
-    std::deque<flit *> m_buffer;
+    static const int InlineCapacity = 4;
+
+    flit *&
+    at(int i)
+    {
+        return m_slots[(m_head + i) & (m_capacity - 1)];
+    }
+
+    void reserve(int capacity);
+
+    // m_slots points to m_inline_slots or to heap storage.
+    // m_capacity is always a power of 2.
+    flit **m_slots;
+    int m_capacity;
+    int m_head;
+    int m_size;
+    flit *m_inline_slots[InlineCapacity];
     int max_size;
 };
 
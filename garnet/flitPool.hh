@@ -0,0 +1,112 @@
+/*
+ * Copyright (c) 2024 The gem5_garnet_wireless authors
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+#ifndef __MEM_RUBY_NETWORK_GARNET_0_FLITPOOL_HH__
+#define __MEM_RUBY_NETWORK_GARNET_0_FLITPOOL_HH__
+
+#include <cstddef>
+#include <new>
+
+namespace gem5
+{
+
+namespace ruby
+{
+
+namespace garnet
+{
+
+/*
+ * Free-list allocator for the objects of one size created and deleted
+ * on the per-flit path (flits and credits).
+ *
+ * Memory is taken from the system in slabs of SlabObjects objects and
+ * is never returned to it: a deleted object goes onto a free list and
+ * is reused by the next allocation. The free lists are thread local,
+ * so event queues running in parallel do not contend. An object may be
+ * deleted by another thread than the one that allocated it, its memory
+ * then simply moves to the free list of that thread.
+ */
+template <std::size_t ObjectSize, std::size_t SlabObjects = 256>
+class flitPool
+{
+  public:
+    static void *
+    allocate()
+    {
+        if (freeList == nullptr)
+            refill();
+
+        FreeNode *node = freeList;
+        freeList = node->next;
+        return node;
+    }
+
+    static void
+    release(void *ptr)
+    {
+        FreeNode *node = static_cast<FreeNode *>(ptr);
+        node->next = freeList;
+        freeList = node;
+    }
+
+  private:
+    struct FreeNode
+    {
+        FreeNode *next;
+    };
+
+    // Object size rounded up to keep every object in a slab aligned
+    static constexpr std::size_t slotSize =
+        ((ObjectSize < sizeof(FreeNode) ? sizeof(FreeNode) : ObjectSize) +
+         alignof(std::max_align_t) - 1) /
+        alignof(std::max_align_t) * alignof(std::max_align_t);
+
+    static void
+    refill()
+    {
+        char *slab = static_cast<char *>(
+            ::operator new(slotSize * SlabObjects));
+        for (std::size_t i = 0; i < SlabObjects; i++) {
+            release(slab + i * slotSize);
+        }
+    }
+
+    static thread_local FreeNode *freeList;
+};
+
+template <std::size_t ObjectSize, std::size_t SlabObjects>
+thread_local typename flitPool<ObjectSize, SlabObjects>::FreeNode *
+    flitPool<ObjectSize, SlabObjects>::freeList = nullptr;
+
+} // namespace garnet
+} // namespace ruby
+} // namespace gem5
+
+#endif // __MEM_RUBY_NETWORK_GARNET_0_FLITPOOL_HH__